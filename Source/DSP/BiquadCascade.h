@@ -0,0 +1,425 @@
+/*
+  ==============================================================================
+
+    BiquadCascade.h
+
+    The EQ's chain of 2nd order sections, processing several channels at once
+    (one per SIMD lane), for any number of channels.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "SIMDVector.h"
+
+#include <array>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Fixed slots in the cascade: the four low cut sections, the peak, then the four high cut sections.
+// This is the same order the old JUCE MonoChain (now only a benchmark baseline) ran its filters in.
+enum CascadePosition
+{
+    CASCADE_LOWCUT_0    = 0,
+    CASCADE_PEAK        = 4,
+    CASCADE_HIGHCUT_0   = 5,
+    CASCADE_NUM_POSITIONS = 9
+};
+
+// A cascade of transposed direct form II biquads with one channel per lane of VectorType.
+// Every position keeps its own state, so (just like a bypassed filter in a ProcessorChain)...
+// ...a section that is switched off freezes its state and picks up where it left off when switched back on.
+// The per-sample arithmetic is identical to juce::dsp::IIR::Filter, so each lane's output matches...
+// ...a MonoChain fed the same coefficients.
+//
+// Unlike a ProcessorChain of IIR::Filters (a ref-counted coefficients object and a heap state array...
+// ...per filter, plus a bypass check per stage), all coefficients and state live in one cache-aligned...
+// ...block, one array per field, and the block is filtered in one fused loop: every active section...
+// ...for frame 0, then frame 1, and so on. (Running each section over the whole block in turn was...
+// ...measured ~30-45% slower: each section's state update is a serial dependency chain, and the fused...
+// ...loop lets the CPU overlap the chains of neighbouring sections.)
+//
+// The EQ only ever produces one shape of active set: a run of low cut sections, maybe the peak, then a...
+// ...run of high cut sections. Each of those 5 x 2 x 5 layouts (all 4 x 4 slopes x 8 bypass states map...
+// ...onto one of them) has its own compile-time kernel with a fixed, unrolled stage list, picked from a...
+// ...table when the sections change. Anything else falls back to the generic loop.
+template<typename VectorType, typename SampleType>
+struct BiquadCascade
+{
+    // b0, b1, b2, a1, a2
+    using Section = std::array<SampleType, 5>;
+    // One entry per position: coefficients, or nullptr to skip it
+    using SectionList = std::array<const Section*, CASCADE_NUM_POSITIONS>;
+
+    // Set a position to run with these coefficients, or to be skipped (nullptr)
+    void setSection(int position, const Section* section)
+    {
+        const auto layoutChanged = storeSection(position, section);
+        if ( layoutChanged )
+            updateLayout();
+    }
+
+    // Every position at once. The active list and kernel are only worked out again if a position was...
+    // ...switched on or off, so a coefficient ramp (same layout, new numbers) is just the broadcasts.
+    void setSections(const SectionList& newSections)
+    {
+        bool layoutChanged = false;
+        for (int i=0; i<CASCADE_NUM_POSITIONS; i++)
+            layoutChanged |= storeSection(i, newSections[(size_t)i]);
+
+        if ( layoutChanged )
+            updateLayout();
+    }
+
+    void reset()
+    {
+        sections.s1.fill(VectorType::broadcast(0));
+        sections.s2.fill(VectorType::broadcast(0));
+    }
+
+    // Filters numFrames frames in place. Each frame holds one sample per channel.
+    void process(VectorType* frames, size_t numFrames)
+    {
+        (this->*kernel)(frames, numFrames);
+    }
+private:
+    using Kernel = void (BiquadCascade::*)(VectorType*, size_t);
+
+    // Copies one position's coefficients in. Returns true if it was switched on or off.
+    bool storeSection(int position, const Section* section)
+    {
+        const auto wasActive = isActive[position];
+        isActive[position] = section != nullptr;
+        if ( section != nullptr )
+        {
+            sections.b0[position] = VectorType::broadcast((*section)[0]);
+            sections.b1[position] = VectorType::broadcast((*section)[1]);
+            sections.b2[position] = VectorType::broadcast((*section)[2]);
+            sections.a1[position] = VectorType::broadcast((*section)[3]);
+            sections.a2[position] = VectorType::broadcast((*section)[4]);
+        }
+        return wasActive != isActive[position];
+    }
+
+    void updateLayout()
+    {
+        // Rebuild the (tiny) list of positions that actually need running
+        numActiveSections = 0;
+        for (int i=0; i<CASCADE_NUM_POSITIONS; i++)
+        {
+            if ( isActive[i] )
+                activePositions[numActiveSections++] = i;
+        }
+
+        chooseKernel();
+    }
+
+    // Generic kernel: walks the active position list for every frame
+    void processAnyLayout(VectorType* frames, size_t numFrames)
+    {
+        for (size_t i=0; i<numFrames; i++)
+        {
+            auto sample = frames[i];
+
+            for (int k=0; k<numActiveSections; k++)
+            {
+                const auto p = activePositions[k];
+
+                auto output = sample * sections.b0[p] + sections.s1[p];
+                sections.s1[p] = (sample * sections.b1[p]) - (output * sections.a1[p]) + sections.s2[p];
+                sections.s2[p] = (sample * sections.b2[p]) - (output * sections.a2[p]);
+                sample = output;
+            }
+
+            frames[i] = sample;
+        }
+
+        // Like IIR::Filter, flush tiny state values once per block
+        for (int k=0; k<numActiveSections; k++)
+        {
+            const auto p = activePositions[k];
+            sections.s1[p] = sections.s1[p].snappedToZero();
+            sections.s2[p] = sections.s2[p].snappedToZero();
+        }
+    }
+
+    // Position of the k'th active section in the layout NumLowCut / HasPeak / NumHighCut
+    template<int NumLowCut, bool HasPeak>
+    static constexpr int getFixedPosition(int k)
+    {
+        if ( k < NumLowCut )
+            return CASCADE_LOWCUT_0 + k;
+        if ( HasPeak && k == NumLowCut )
+            return CASCADE_PEAK;
+        return CASCADE_HIGHCUT_0 + k - NumLowCut - (HasPeak ? 1 : 0);
+    }
+
+    static void processSample(VectorType& sample,
+                              VectorType b0, VectorType b1, VectorType b2, VectorType a1, VectorType a2,
+                              VectorType& s1, VectorType& s2)
+    {
+        auto output = sample * b0 + s1;
+        s1 = (sample * b1) - (output * a1) + s2;
+        s2 = (sample * b2) - (output * a2);
+        sample = output;
+    }
+
+    // Fixed layout kernel: the stage list is known at compile time, so there's no list to walk and...
+    // ...the coefficients and state can live in registers (local copies, which frames can't alias)...
+    // ...for the whole block
+    template<int NumLowCut, bool HasPeak, int NumHighCut>
+    void processFixed(VectorType* frames, size_t numFrames)
+    {
+        processFixedSections<NumLowCut, HasPeak>(frames, numFrames,
+                                                 std::make_integer_sequence<int, NumLowCut + (HasPeak ? 1 : 0) + NumHighCut>());
+    }
+
+    template<int NumLowCut, bool HasPeak, int... K>
+    void processFixedSections(VectorType* frames, size_t numFrames, std::integer_sequence<int, K...>)
+    {
+        if constexpr (sizeof...(K) > 0)
+        {
+            const std::array<VectorType, sizeof...(K)> b0 { sections.b0[getFixedPosition<NumLowCut, HasPeak>(K)]... };
+            const std::array<VectorType, sizeof...(K)> b1 { sections.b1[getFixedPosition<NumLowCut, HasPeak>(K)]... };
+            const std::array<VectorType, sizeof...(K)> b2 { sections.b2[getFixedPosition<NumLowCut, HasPeak>(K)]... };
+            const std::array<VectorType, sizeof...(K)> a1 { sections.a1[getFixedPosition<NumLowCut, HasPeak>(K)]... };
+            const std::array<VectorType, sizeof...(K)> a2 { sections.a2[getFixedPosition<NumLowCut, HasPeak>(K)]... };
+            std::array<VectorType, sizeof...(K)> s1 { sections.s1[getFixedPosition<NumLowCut, HasPeak>(K)]... };
+            std::array<VectorType, sizeof...(K)> s2 { sections.s2[getFixedPosition<NumLowCut, HasPeak>(K)]... };
+
+            for (size_t i=0; i<numFrames; i++)
+            {
+                auto sample = frames[i];
+                (processSample(sample, b0[K], b1[K], b2[K], a1[K], a2[K], s1[K], s2[K]), ...);
+                frames[i] = sample;
+            }
+
+            // Like IIR::Filter, flush tiny state values once per block
+            ((sections.s1[getFixedPosition<NumLowCut, HasPeak>(K)] = s1[K].snappedToZero()), ...);
+            ((sections.s2[getFixedPosition<NumLowCut, HasPeak>(K)] = s2[K].snappedToZero()), ...);
+        }
+        else
+        {
+            (void)frames;
+            (void)numFrames;
+        }
+    }
+
+    // One row of the kernel table: every high cut length for a given low cut length and peak state
+    template<int NumLowCut, bool HasPeak>
+    static constexpr std::array<Kernel, 5> kernelRow
+    {
+        &BiquadCascade::processFixed<NumLowCut, HasPeak, 0>,
+        &BiquadCascade::processFixed<NumLowCut, HasPeak, 1>,
+        &BiquadCascade::processFixed<NumLowCut, HasPeak, 2>,
+        &BiquadCascade::processFixed<NumLowCut, HasPeak, 3>,
+        &BiquadCascade::processFixed<NumLowCut, HasPeak, 4>
+    };
+
+    // Indexed by [number of low cut sections * 2 + peak on][number of high cut sections]
+    static constexpr std::array<std::array<Kernel, 5>, 10> kernelTable
+    {
+        kernelRow<0, false>, kernelRow<0, true>,
+        kernelRow<1, false>, kernelRow<1, true>,
+        kernelRow<2, false>, kernelRow<2, true>,
+        kernelRow<3, false>, kernelRow<3, true>,
+        kernelRow<4, false>, kernelRow<4, true>
+    };
+
+    void chooseKernel()
+    {
+        int numLowCut = 0;
+        while ( numLowCut < 4 && isActive[CASCADE_LOWCUT_0 + numLowCut] )
+            numLowCut++;
+
+        int numHighCut = 0;
+        while ( numHighCut < 4 && isActive[CASCADE_HIGHCUT_0 + numHighCut] )
+            numHighCut++;
+
+        const auto hasPeak = isActive[CASCADE_PEAK];
+
+        // Only use a fixed kernel if that layout really covers every active section
+        if ( numLowCut + (hasPeak ? 1 : 0) + numHighCut == numActiveSections )
+            kernel = kernelTable[(size_t)(numLowCut * 2 + (hasPeak ? 1 : 0))][(size_t)numHighCut];
+        else
+            kernel = &BiquadCascade::processAnyLayout;
+    }
+
+    // Coefficients and state for every position, struct-of-arrays style
+    struct alignas(64) SectionArrays
+    {
+        std::array<VectorType, CASCADE_NUM_POSITIONS> b0 {}, b1 {}, b2 {}, a1 {}, a2 {};
+        std::array<VectorType, CASCADE_NUM_POSITIONS> s1 {}, s2 {};
+    };
+
+    SectionArrays sections;
+    std::array<bool, CASCADE_NUM_POSITIONS> isActive {};
+
+    std::array<int, CASCADE_NUM_POSITIONS> activePositions {};
+    int numActiveSections = 0;
+
+    Kernel kernel = &BiquadCascade::processAnyLayout;
+};
+
+// Runs any number of channels through the cascade, packing as many channels as fit into each...
+// ...SIMD register (for float: 8 with AVX, otherwise 4), then pairs, then a single scalar channel...
+// ...for what's left. e.g. stereo is one 2-lane pass, 5.1 is a 4-lane pass plus a 2-lane pass, and...
+// ...7.1.4 is three 4-lane passes (or 8 + 4 with AVX), so the cost per channel drops as the channel...
+// ...count goes up. SampleType is float or double; both share the same cascade code.
+template<typename SampleType>
+struct MultiChannelCascade
+{
+    using Section = typename BiquadCascade<SIMDVector<SampleType, 1>, SampleType>::Section;
+    using SectionList = typename BiquadCascade<SIMDVector<SampleType, 1>, SampleType>::SectionList;
+
+    static constexpr int widestLanes = std::is_same<SampleType, double>::value ? widestDoubleVectorLanes
+                                                                                : widestFloatVectorLanes;
+
+    // Works out the channel batches and allocates their interleaving buffers.
+    // Blocks longer than maximumBlockSize still work, in several passes.
+    void prepare(int numChannels, int maximumBlockSize)
+    {
+        maxFrames = maximumBlockSize > 0 ? maximumBlockSize : 1;
+
+        int channel = 0;
+        channel = addBatches(batches8, frames8, channel, widestLanes >= 8 ? numChannels : 0);
+        channel = addBatches(batches4, frames4, channel, widestLanes >= 4 ? numChannels : 0);
+        channel = addBatches(batches2, frames2, channel, widestLanes >= 2 ? numChannels : 0);
+        addBatches(batches1, frames1, channel, numChannels);
+
+        // (new batches start out with every position off, so this sets the layout up too)
+        SectionList sectionList {};
+        for (int i=0; i<CASCADE_NUM_POSITIONS; i++)
+            sectionList[(size_t)i] = isActive[i] ? &sections[i] : nullptr;
+        forEachBatch([&sectionList] (auto& batch) { batch.cascade.setSections(sectionList); });
+
+        reset();
+    }
+
+    void reset()
+    {
+        forEachBatch([] (auto& batch) { batch.cascade.reset(); });
+    }
+
+    // Set a position to run with these coefficients, or to be skipped (nullptr), on every channel
+    void setSection(int position, const Section* section)
+    {
+        isActive[position] = section != nullptr;
+        if ( section != nullptr )
+            sections[position] = *section;
+
+        forEachBatch([position, section] (auto& batch) { batch.cascade.setSection(position, section); });
+    }
+
+    // Every position at once, resolving each batch's layout once rather than once per position
+    void setSections(const SectionList& newSections)
+    {
+        for (int i=0; i<CASCADE_NUM_POSITIONS; i++)
+        {
+            isActive[i] = newSections[(size_t)i] != nullptr;
+            if ( isActive[i] )
+                sections[i] = *newSections[(size_t)i];
+        }
+
+        forEachBatch([&newSections] (auto& batch) { batch.cascade.setSections(newSections); });
+    }
+
+    // Filters samples [startSample, startSample + numSamples) of each channel in place.
+    // Channels past the count given to prepare() are left alone.
+    void process(SampleType* const* channels, int numChannels, int startSample, int numSamples)
+    {
+        for (auto& batch : batches8)    processBatch(batch, frames8, channels, numChannels, startSample, numSamples);
+        for (auto& batch : batches4)    processBatch(batch, frames4, channels, numChannels, startSample, numSamples);
+        for (auto& batch : batches2)    processBatch(batch, frames2, channels, numChannels, startSample, numSamples);
+        for (auto& batch : batches1)    processBatch(batch, frames1, channels, numChannels, startSample, numSamples);
+    }
+private:
+    template<int Lanes>
+    struct Batch
+    {
+        using Vector = SIMDVector<SampleType, Lanes>;
+
+        int firstChannel = 0;
+        BiquadCascade<Vector, SampleType> cascade;
+    };
+
+    // Adds as many Lanes-wide batches as fit in the remaining channels, and returns the first channel left over
+    template<int Lanes>
+    int addBatches(std::vector<Batch<Lanes>>& batches, std::vector<typename Batch<Lanes>::Vector>& frames,
+                   int firstChannel, int numChannels)
+    {
+        batches.clear();
+        for (; firstChannel + Lanes <= numChannels; firstChannel += Lanes)
+        {
+            batches.emplace_back();
+            batches.back().firstChannel = firstChannel;
+        }
+
+        frames.resize(batches.empty() ? 0 : (size_t)maxFrames);
+        return firstChannel;
+    }
+
+    template<typename Function>
+    void forEachBatch(Function&& function)
+    {
+        for (auto& batch : batches8)    function(batch);
+        for (auto& batch : batches4)    function(batch);
+        for (auto& batch : batches2)    function(batch);
+        for (auto& batch : batches1)    function(batch);
+    }
+
+    template<int Lanes>
+    static void processBatch(Batch<Lanes>& batch, std::vector<typename Batch<Lanes>::Vector>& frames,
+                             SampleType* const* channels, int numChannels, int startSample, int numSamples)
+    {
+        using Vector = typename Batch<Lanes>::Vector;
+
+        if ( batch.firstChannel + Lanes > numChannels )
+            return;
+
+        SampleType* const* batchChannels = channels + batch.firstChannel;
+        const auto chunkSize = (int)frames.size();
+
+        for (int start=startSample; start<startSample + numSamples; start += chunkSize)
+        {
+            const auto numFrames = startSample + numSamples - start < chunkSize ? startSample + numSamples - start : chunkSize;
+
+            // Interleave: frame i = { channel 0 [i], channel 1 [i], ... }
+            for (int i=0; i<numFrames; i++)
+            {
+                alignas(32) SampleType frame[Lanes];
+                for (int lane=0; lane<Lanes; lane++)
+                    frame[lane] = batchChannels[lane][start + i];
+                frames[(size_t)i] = Vector::fromLanes(frame);
+            }
+
+            batch.cascade.process(frames.data(), (size_t)numFrames);
+
+            // ...and back again
+            for (int i=0; i<numFrames; i++)
+            {
+                alignas(32) SampleType frame[Lanes];
+                frames[(size_t)i].toLanes(frame);
+                for (int lane=0; lane<Lanes; lane++)
+                    batchChannels[lane][start + i] = frame[lane];
+            }
+        }
+    }
+
+    std::vector<Batch<8>> batches8;
+    std::vector<Batch<4>> batches4;
+    std::vector<Batch<2>> batches2;
+    std::vector<Batch<1>> batches1;
+
+    std::vector<SIMDVector<SampleType, 8>> frames8;
+    std::vector<SIMDVector<SampleType, 4>> frames4;
+    std::vector<SIMDVector<SampleType, 2>> frames2;
+    std::vector<SIMDVector<SampleType, 1>> frames1;
+
+    // Kept so batches created by a later prepare() start with the current coefficients
+    std::array<Section, CASCADE_NUM_POSITIONS> sections {};
+    std::array<bool, CASCADE_NUM_POSITIONS> isActive {};
+    int maxFrames = 1;
+};
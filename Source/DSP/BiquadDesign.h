@@ -0,0 +1,199 @@
+/*
+  ==============================================================================
+
+    BiquadDesign.h
+
+    Allocation-free, fixed-size filter designs for the EQ's 2nd order sections.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+// Minimal constexpr stand-ins for the <cmath> functions our filter designs need.
+// (std::sin and friends aren't constexpr in C++17, and we want designs to work at compile time too.)
+// Accurate to within a few ULP of double, which is far more than the float coefficients can hold.
+struct ConstexprMath
+{
+    static constexpr double pi = 3.14159265358979323846;
+    static constexpr double ln2 = 0.69314718055994530942;
+    static constexpr double ln10 = 2.30258509299404568402;
+
+    static constexpr double roundToInteger(double x)
+    {
+        return (double)(long long)(x < 0.0 ? x - 0.5 : x + 0.5);
+    }
+
+    static constexpr double sin(double x)
+    {
+        // Reduce to [-pi, pi], then fold into [-pi/2, pi/2] where the Taylor series converges quickly
+        x -= 2.0 * pi * roundToInteger(x / (2.0 * pi));
+        if ( x > pi / 2.0 )
+            x = pi - x;
+        else if ( x < -pi / 2.0 )
+            x = -pi - x;
+
+        const auto xSquared = x * x;
+        auto term = x;
+        auto sum = x;
+        for (int n=1; n<12; n++)
+        {
+            term *= -xSquared / (double)((2 * n) * (2 * n + 1));
+            sum += term;
+        }
+        return sum;
+    }
+
+    static constexpr double cos(double x) { return sin(x + pi / 2.0); }
+
+    static constexpr double tan(double x) { return sin(x) / cos(x); }
+
+    static constexpr double sqrt(double x)
+    {
+        if ( x <= 0.0 )
+            return 0.0;
+
+        // Newton's method, starting above the root so it converges monotonically downwards
+        auto root = x > 1.0 ? x : 1.0;
+        for (int i=0; i<200; i++)
+        {
+            auto next = 0.5 * (root + x / root);
+            if ( next >= root )
+                break;
+            root = next;
+        }
+        return root;
+    }
+
+    static constexpr double exp(double x)
+    {
+        // exp(x) = 2^k * exp(r), with |r| <= ln2 / 2
+        auto k = (long long)roundToInteger(x / ln2);
+        auto r = x - (double)k * ln2;
+
+        auto term = 1.0;
+        auto sum = 1.0;
+        for (int n=1; n<20; n++)
+        {
+            term *= r / (double)n;
+            sum += term;
+        }
+
+        for (; k > 0; k--)
+            sum *= 2.0;
+        for (; k < 0; k++)
+            sum *= 0.5;
+        return sum;
+    }
+
+    // Same as juce::Decibels::decibelsToGain (with its default -100 dB floor)
+    static constexpr double decibelsToGain(double decibels)
+    {
+        return decibels > -100.0 ? exp(decibels * 0.05 * ln10) : 0.0;
+    }
+};
+
+// Designs 2nd order sections straight into caller-provided std::arrays.
+// No heap, no reference counting, and every function is constexpr, so fixed settings can be...
+// ...designed at compile time, e.g.
+//     constexpr auto rumbleFilter = [] { FixedFilterDesign<float>::Cascade<4> c {};
+//                                        FixedFilterDesign<float>::designButterworthHighPass(c, 30.0, 48000.0, 8);
+//                                        return c; }();
+// The formulas match juce::dsp::IIR::Coefficients::makeLowPass/makeHighPass/makePeakFilter and...
+// ...juce::dsp::FilterDesign's high order Butterworth methods, but are evaluated in double...
+// ...precision before rounding to FloatType.
+template<typename FloatType>
+struct FixedFilterDesign
+{
+    // Normalised coefficients of one 2nd order section: b0, b1, b2, a1, a2 (a0 divided out)
+    using Section = std::array<FloatType, 5>;
+
+    template<size_t MaxSections>
+    using Cascade = std::array<Section, MaxSections>;
+
+    static constexpr Section makeLowPass(double sampleRate, double frequency, double Q)
+    {
+        const auto n = 1.0 / ConstexprMath::tan(ConstexprMath::pi * frequency / sampleRate);
+        const auto nSquared = n * n;
+        const auto invQ = 1.0 / Q;
+        const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+        return {{ (FloatType)c1,
+                  (FloatType)(c1 * 2.0),
+                  (FloatType)c1,
+                  (FloatType)(c1 * 2.0 * (1.0 - nSquared)),
+                  (FloatType)(c1 * (1.0 - invQ * n + nSquared)) }};
+    }
+
+    static constexpr Section makeHighPass(double sampleRate, double frequency, double Q)
+    {
+        const auto n = ConstexprMath::tan(ConstexprMath::pi * frequency / sampleRate);
+        const auto nSquared = n * n;
+        const auto invQ = 1.0 / Q;
+        const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+        return {{ (FloatType)c1,
+                  (FloatType)(c1 * -2.0),
+                  (FloatType)c1,
+                  (FloatType)(c1 * 2.0 * (nSquared - 1.0)),
+                  (FloatType)(c1 * (1.0 - invQ * n + nSquared)) }};
+    }
+
+    static constexpr Section makePeakFilter(double sampleRate, double frequency, double Q, double gainFactor)
+    {
+        const auto A = ConstexprMath::sqrt(gainFactor > 0.0 ? gainFactor : 0.0);
+        const auto omega = (2.0 * ConstexprMath::pi * (frequency > 2.0 ? frequency : 2.0)) / sampleRate;
+        const auto alpha = ConstexprMath::sin(omega) / (Q * 2.0);
+        const auto c2 = -2.0 * ConstexprMath::cos(omega);
+        const auto alphaTimesA = alpha * A;
+        const auto alphaOverA = alpha / A;
+        const auto a0Inverse = 1.0 / (1.0 + alphaOverA);
+
+        return {{ (FloatType)((1.0 + alphaTimesA) * a0Inverse),
+                  (FloatType)(c2 * a0Inverse),
+                  (FloatType)((1.0 - alphaTimesA) * a0Inverse),
+                  (FloatType)(c2 * a0Inverse),
+                  (FloatType)((1.0 - alphaOverA) * a0Inverse) }};
+    }
+
+    // Q of section 'sectionIndex' in an even-order Butterworth cascade
+    static constexpr double getButterworthQ(int order, int sectionIndex)
+    {
+        return 1.0 / (2.0 * ConstexprMath::cos((2.0 * sectionIndex + 1.0) * ConstexprMath::pi / (order * 2.0)));
+    }
+
+    // Writes the order / 2 sections of an even-order (2, 4, 6, 8...) Butterworth low pass into the...
+    // ...start of 'sections', and returns how many were written. Entries past that are left untouched.
+    template<size_t MaxSections>
+    static constexpr int designButterworthLowPass(Cascade<MaxSections>& sections,
+                                                  double frequency, double sampleRate, int order)
+    {
+        const auto numSections = order / 2 < (int)MaxSections ? order / 2 : (int)MaxSections;
+        for (int i=0; i<numSections; i++)
+            sections[(size_t)i] = makeLowPass(sampleRate, frequency, getButterworthQ(order, i));
+        return numSections;
+    }
+
+    // High pass equivalent of designButterworthLowPass
+    template<size_t MaxSections>
+    static constexpr int designButterworthHighPass(Cascade<MaxSections>& sections,
+                                                   double frequency, double sampleRate, int order)
+    {
+        const auto numSections = order / 2 < (int)MaxSections ? order / 2 : (int)MaxSections;
+        for (int i=0; i<numSections; i++)
+            sections[(size_t)i] = makeHighPass(sampleRate, frequency, getButterworthQ(order, i));
+        return numSections;
+    }
+};
+
+// Designs really are usable at compile time: a 2nd order Butterworth low pass at a quarter of the...
+// ...sample rate has b0 = 1 / (2 + sqrt(2)).
+static_assert( [] {
+                   FixedFilterDesign<double>::Cascade<1> cascade {};
+                   FixedFilterDesign<double>::designButterworthLowPass(cascade, 12000.0, 48000.0, 2);
+                   auto error = cascade[0][0] - 0.29289321881345248;
+                   return error < 1.0e-12 && error > -1.0e-12;
+               }(), "FixedFilterDesign should run at compile time");
@@ -0,0 +1,195 @@
+/*
+  ==============================================================================
+
+    ChainDesign.cpp
+
+  ==============================================================================
+*/
+
+#include "ChainDesign.h"
+
+#include <complex>
+
+void updateChainCoefficients(ChainCoefficients& chainCoefficients,
+                             const ChainSettings& chainSettings,
+                             double sampleRate,
+                             int bandsToUpdate)
+{
+    // The cut filter designs hold one 2nd order section per 12 dB/oct of slope
+    if ( bandsToUpdate & LOWCUT_BAND )
+    {
+        chainCoefficients.lowCutSlope  = chainSettings.lowCutSlope;
+        chainCoefficients.lowCutBypass = chainSettings.lowCutBypass;
+        
+        makeLowCutFilter(chainCoefficients.lowCut, chainSettings, sampleRate);
+    }
+    
+    if ( bandsToUpdate & PEAK_BAND )
+    {
+        chainCoefficients.peakBypass = chainSettings.peakBypass;
+        chainCoefficients.peak = makePeakFilter(chainSettings, sampleRate);
+    }
+    
+    if ( bandsToUpdate & HIGHCUT_BAND )
+    {
+        chainCoefficients.highCutSlope  = chainSettings.highCutSlope;
+        chainCoefficients.highCutBypass = chainSettings.highCutBypass;
+        
+        makeHighCutFilter(chainCoefficients.highCut, chainSettings, sampleRate);
+    }
+}
+
+// A designed (double) section in the cascade's sample type
+template<typename SampleType>
+static typename MultiChannelCascade<SampleType>::Section toCascadeSection(const SectionCoefficients& section)
+{
+    return {{ (SampleType)section[0], (SampleType)section[1], (SampleType)section[2],
+              (SampleType)section[3], (SampleType)section[4] }};
+}
+
+template<typename SampleType>
+void applyChainCoefficients(MultiChannelCascade<SampleType>& cascade, const ChainCoefficients& chainCoefficients)
+{
+    using Section = typename MultiChannelCascade<SampleType>::Section;
+    
+    std::array<Section, CASCADE_NUM_POSITIONS> converted;
+    typename MultiChannelCascade<SampleType>::SectionList sectionList {};
+    
+    // Cut filter section N only runs for slopes steeper than N * 12 dB/oct
+    for (int i=0; i<4; i++)
+    {
+        auto lowCutNeeded = ! chainCoefficients.lowCutBypass && i <= chainCoefficients.lowCutSlope;
+        auto highCutNeeded = ! chainCoefficients.highCutBypass && i <= chainCoefficients.highCutSlope;
+        
+        converted[CASCADE_LOWCUT_0 + i] = toCascadeSection<SampleType>(chainCoefficients.lowCut[i]);
+        converted[CASCADE_HIGHCUT_0 + i] = toCascadeSection<SampleType>(chainCoefficients.highCut[i]);
+        sectionList[CASCADE_LOWCUT_0 + i] = lowCutNeeded ? &converted[CASCADE_LOWCUT_0 + i] : nullptr;
+        sectionList[CASCADE_HIGHCUT_0 + i] = highCutNeeded ? &converted[CASCADE_HIGHCUT_0 + i] : nullptr;
+    }
+    
+    converted[CASCADE_PEAK] = toCascadeSection<SampleType>(chainCoefficients.peak);
+    sectionList[CASCADE_PEAK] = chainCoefficients.peakBypass ? nullptr : &converted[CASCADE_PEAK];
+    
+    // All nine in one go: the layout is worked out once, and only if a section was switched on or off
+    cascade.setSections(sectionList);
+}
+
+static double getSectionMagnitudeForFrequency(const SectionCoefficients& section, double frequency, double sampleRate)
+{
+    // H(z) = (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2), on the unit circle
+    const auto zInverse = std::polar(1.0, -2.0 * ConstexprMath::pi * frequency / sampleRate);
+    const auto zInverseSquared = zInverse * zInverse;
+    
+    return std::abs((section[0] + section[1] * zInverse + section[2] * zInverseSquared)
+                    / (1.0 + section[3] * zInverse + section[4] * zInverseSquared));
+}
+
+double getChainMagnitudeForFrequency(const ChainCoefficients& chainCoefficients, double frequency, double sampleRate)
+{
+    auto magnitude = 1.0;
+    
+    if ( ! chainCoefficients.lowCutBypass )
+        for (int i=0; i<=chainCoefficients.lowCutSlope; i++)
+            magnitude *= getSectionMagnitudeForFrequency(chainCoefficients.lowCut[i], frequency, sampleRate);
+    
+    if ( ! chainCoefficients.peakBypass )
+        magnitude *= getSectionMagnitudeForFrequency(chainCoefficients.peak, frequency, sampleRate);
+    
+    if ( ! chainCoefficients.highCutBypass )
+        for (int i=0; i<=chainCoefficients.highCutSlope; i++)
+            magnitude *= getSectionMagnitudeForFrequency(chainCoefficients.highCut[i], frequency, sampleRate);
+    
+    return magnitude;
+}
+
+template void applyChainCoefficients<float>(MultiChannelCascade<float>&, const ChainCoefficients&);
+template void applyChainCoefficients<double>(MultiChannelCascade<double>&, const ChainCoefficients&);
+
+//=======================================================================================
+// Coefficient smoothing
+//=======================================================================================
+
+void ChainCoefficientSmoother::reset()
+{
+    hasTarget = false;
+    ticksRemaining = 0;
+}
+
+void ChainCoefficientSmoother::setTarget(const ChainCoefficients& newTarget, int rampLengthInTicks)
+{
+    target = newTarget;
+    
+    // Nothing to ramp from (or no ramp wanted): jump
+    if ( ! hasTarget || rampLengthInTicks <= 0 )
+    {
+        current = target;
+        ticksRemaining = 0;
+        hasTarget = true;
+        return;
+    }
+    
+    // A different slope or bypass state changes which sections run, so there is nothing to...
+    // ...interpolate between: those bands jump, the rest ramp from wherever they currently are
+    if ( current.lowCutSlope != target.lowCutSlope || current.lowCutBypass != target.lowCutBypass )
+    {
+        current.lowCut       = target.lowCut;
+        current.lowCutSlope  = target.lowCutSlope;
+        current.lowCutBypass = target.lowCutBypass;
+    }
+    if ( current.peakBypass != target.peakBypass )
+    {
+        current.peak       = target.peak;
+        current.peakBypass = target.peakBypass;
+    }
+    if ( current.highCutSlope != target.highCutSlope || current.highCutBypass != target.highCutBypass )
+    {
+        current.highCut       = target.highCut;
+        current.highCutSlope  = target.highCutSlope;
+        current.highCutBypass = target.highCutBypass;
+    }
+    
+    ticksRemaining = rampLengthInTicks;
+}
+
+const ChainCoefficients& ChainCoefficientSmoother::skipToTarget()
+{
+    current = target;
+    ticksRemaining = 0;
+    return current;
+}
+
+// Move a section 1/ticksRemaining of the way towards its target (a straight line over the whole ramp)
+static void stepSectionTowards(SectionCoefficients& section, const SectionCoefficients& targetSection, double fraction)
+{
+    for (size_t i=0; i<section.size(); i++)
+        section[i] += (targetSection[i] - section[i]) * fraction;
+}
+
+const ChainCoefficients& ChainCoefficientSmoother::tick()
+{
+    if ( ticksRemaining <= 0 )
+        return current;
+    
+    // Last tick of the ramp: land exactly on the target
+    if ( --ticksRemaining == 0 )
+    {
+        current = target;
+        return current;
+    }
+    
+    const auto fraction = 1.0 / (double)(ticksRemaining + 1);
+    
+    // Only the sections that will actually run are worth interpolating
+    if ( ! current.lowCutBypass )
+        for (int i=0; i<=current.lowCutSlope; i++)
+            stepSectionTowards(current.lowCut[i], target.lowCut[i], fraction);
+    
+    if ( ! current.peakBypass )
+        stepSectionTowards(current.peak, target.peak, fraction);
+    
+    if ( ! current.highCutBypass )
+        for (int i=0; i<=current.highCutSlope; i++)
+            stepSectionTowards(current.highCut[i], target.highCut[i], fraction);
+    
+    return current;
+}
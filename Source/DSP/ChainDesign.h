@@ -0,0 +1,124 @@
+/*
+  ==============================================================================
+
+    ChainDesign.h
+
+    Filter design for the whole chain, and the coefficient smoother.
+    Plain C++ (no JUCE): runs anywhere the DSP core does.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "ChainSettings.h"
+#include "BiquadDesign.h"
+#include "BiquadCascade.h"
+
+// Normalised coefficients of a single 2nd order (12dB/oct) section: b0, b1, b2, a1, a2.
+// Same layout as the raw array inside a 2nd order juce::dsp::IIR::Coefficients.
+// Kept in double, so the double precision path gets full precision coefficients (a 20 Hz low cut at...
+// ...192 kHz needs them); the float paths round them as they copy them in.
+using SectionCoefficients = FixedFilterDesign<double>::Section;
+using CutFilterCoefficients = FixedFilterDesign<double>::Cascade<4>;
+
+// Calculate Peak filter coefficients based on current chain settings. Allocation free.
+inline SectionCoefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return FixedFilterDesign<double>::makePeakFilter(sampleRate,
+                                                     chainSettings.peakFreq,
+                                                     chainSettings.peakQ,
+                                                     ConstexprMath::decibelsToGain(chainSettings.peakGain_dB));
+}
+
+// Calculate the low cut filter coefficients straight into 'sections'. Allocation free.
+// Returns the number of 12dB/oct sections used.
+inline int makeLowCutFilter(CutFilterCoefficients& sections, const ChainSettings& chainSettings, double sampleRate)
+{
+    // Calculate filter order (2, 4, 6, or 8) from filter slope parameters (0, 1, 2, or 3)
+    auto lowCutFilterOrder = 2 * (chainSettings.lowCutSlope + 1);
+    return FixedFilterDesign<double>::designButterworthHighPass(sections,
+                                                                chainSettings.lowCutFreq,
+                                                                sampleRate,
+                                                                lowCutFilterOrder);
+}
+
+// Calculate the high cut filter coefficients straight into 'sections'. Allocation free.
+// Returns the number of 12dB/oct sections used.
+inline int makeHighCutFilter(CutFilterCoefficients& sections, const ChainSettings& chainSettings, double sampleRate)
+{
+    // Calculate filter order (2, 4, 6, or 8) from filter slope parameters (0, 1, 2, or 3)
+    auto highCutFilterOrder = 2 * (chainSettings.highCutSlope + 1);
+    return FixedFilterDesign<double>::designButterworthLowPass(sections,
+                                                               chainSettings.highCutFreq,
+                                                               sampleRate,
+                                                               highCutFilterOrder);
+}
+
+// Every coefficient and bypass flag needed to configure the chain.
+// Designed ahead of time on a non-realtime thread, so applying it on the audio thread...
+// ...is nothing more than copying numbers.
+struct ChainCoefficients
+{
+    CutFilterCoefficients lowCut {}, highCut {};
+    SectionCoefficients peak {};
+    
+    Slope lowCutSlope {Slope::SLOPE_12}, highCutSlope {Slope::SLOPE_12};
+    bool lowCutBypass {false}, highCutBypass {false}, peakBypass {false};
+};
+
+// Runs the filter design for the given bands (a BandMask), leaving the other bands untouched.
+// Allocation and lock free, but still a handful of trig calls per section.
+void updateChainCoefficients(ChainCoefficients& chainCoefficients,
+                             const ChainSettings& chainSettings,
+                             double sampleRate,
+                             int bandsToUpdate = ALL_BANDS);
+
+// Copies pre-designed coefficients into the multichannel SIMD chains (float or double). Allocation free.
+template<typename SampleType>
+void applyChainCoefficients(MultiChannelCascade<SampleType>& cascade, const ChainCoefficients& chainCoefficients);
+
+// Combined magnitude (as a gain) of every section that runs, at this frequency.
+// sampleRate is the rate the coefficients were designed for.
+double getChainMagnitudeForFrequency(const ChainCoefficients& chainCoefficients, double frequency, double sampleRate);
+
+// Ramps the coefficients applied to the chains towards a newly designed set, one small linear step...
+// ...per control tick, instead of jumping there at a block boundary (which zippers under automation).
+// A biquad's (a1, a2) stability region is a triangle, which is convex, so every section on the straight...
+// ...line between two stable sections is stable too: interpolating can't make the filter blow up.
+// Slope and bypass changes can't be interpolated, so the affected band jumps straight to its target.
+//
+// Cost per control tick, per active 2nd order section: 5 subtract/multiply/adds to interpolate...
+// ...plus 5 broadcasts per channel batch in the MultiChannelCascade (only the chain of the precision...
+// ...being processed gets them, and the cascade's layout is only worked out again when a section is...
+// ...switched on or off). Active sections by slope (both cut filters on, peak on):
+//   SLOPE_12: 3 sections,  SLOPE_24: 5,  SLOPE_36: 7,  SLOPE_48: 9
+// Measured ("smootherTick" in Tools/Benchmarks: tick() + applyChainCoefficients, stereo float, x86-64...
+// ...SSE2, -O2), per tick:
+//   SLOPE_12: ~98 ns,  SLOPE_24: ~98 ns,  SLOPE_36: ~132 ns,  SLOPE_48: ~142 ns
+// i.e. about 4.5 ns per sample at the 32-sample control interval, 48 dB/oct. (Applying to both...
+// ...precisions' chains with the layout redone per section, as before, was 370-490 ns per tick.)
+// processBlock/automation has the whole thing: design + ramp + filtering, per control interval.
+// No allocation, no locks, no trig: all filter design stays on the design thread.
+struct ChainCoefficientSmoother
+{
+    // Forget the current state; the next target is jumped to rather than ramped to
+    void reset();
+    
+    // Start ramping towards newTarget over rampLengthInTicks control ticks (0 = jump straight there)
+    void setTarget(const ChainCoefficients& newTarget, int rampLengthInTicks);
+    
+    bool isSmoothing() const { return ticksRemaining > 0; }
+    
+    // Advance one control tick and return the coefficients to use for it
+    const ChainCoefficients& tick();
+    
+    // Abandon any ramp in progress and return the target
+    const ChainCoefficients& skipToTarget();
+    
+    const ChainCoefficients& getCurrent() const { return current; }
+private:
+    ChainCoefficients current, target;
+    int ticksRemaining = 0;
+    bool hasTarget = false;
+};
@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    ChainSettings.h
+
+    Every setting of the EQ's filter chain, in plain C++ (no JUCE).
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+
+// Filter slope enum
+enum Slope
+{
+    SLOPE_12,
+    SLOPE_24,
+    SLOPE_36,
+    SLOPE_48
+};
+
+// Set up a struct to contain all parameter settings in the chain
+struct ChainSettings
+{
+    float lowCutFreq {0}, highCutFreq {0};
+    Slope lowCutSlope {Slope::SLOPE_12}, highCutSlope {Slope::SLOPE_12};
+    float peakFreq {0}, peakGain_dB {0}, peakQ {1.f};
+    
+    bool lowCutBypass {false}, highCutBypass {false}, peakBypass {false};
+};
+
+// Define enum to simplify accessing each link in the processing chain
+enum ChainPositions{
+    LowCut,     //0
+    Peak,       //1
+    HighCut     //2
+};
+
+// Bit masks for sets of bands in the chain (one bit per ChainPositions value)
+enum BandMask
+{
+    LOWCUT_BAND  = 1 << ChainPositions::LowCut,
+    PEAK_BAND    = 1 << ChainPositions::Peak,
+    HIGHCUT_BAND = 1 << ChainPositions::HighCut,
+    ALL_BANDS    = LOWCUT_BAND | PEAK_BAND | HIGHCUT_BAND
+};
+
+// Smoothing control rates offered by the "Smoothing" parameter, in samples per control tick (0 = off)
+inline constexpr std::array<int, 4> smoothingControlIntervals { 0, 16, 32, 64 };
+
+// Oversampling choices offered by the "Oversampling" parameter, as a number of 2x stages (0 = off, 1 = 2x, 2 = 4x)
+inline constexpr int maxOversamplingStages = 2;
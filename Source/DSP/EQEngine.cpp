@@ -0,0 +1,268 @@
+/*
+  ==============================================================================
+
+    EQEngine.cpp
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+#include "EQEngine.h"
+#include "ChainDesign.h"
+#include "OversampledChain.h"
+#include "LinearPhaseConvolver.h"
+#include "TripleBuffer.h"
+
+#include <atomic>
+#include <mutex>
+
+struct EQEngine::Impl
+{
+    // Every channel, processed several at a time in SIMD cascades.
+    // Only the one matching the processing precision gets channels, or coefficients.
+    OversampledChain<float> floatChain;
+    OversampledChain<double> doubleChain;
+    
+    template<typename SampleType>
+    OversampledChain<SampleType>& getChain()
+    {
+        if constexpr (std::is_same<SampleType, double>::value)
+            return doubleChain;
+        else
+            return floatChain;
+    }
+    
+    // Number of 2x oversampling stages in use, and whether the linear phase FIR replaces the IIR chain.
+    // Read by the audio thread; only ever changed in prepare or setProcessingMode.
+    int oversamplingStages = 0;
+    bool linearPhase = false;
+    bool doublePrecision = false;
+    double sampleRate = 0.0;
+    
+    // Linear phase mode. Its kernel is rebuilt by whoever designs the coefficients, whenever they...
+    // ...change and linearPhaseKernelWanted is set.
+    LinearPhaseConvolver linearPhaseConvolver;
+    std::atomic<bool> linearPhaseKernelWanted {false};
+    
+    // Audio thread only: ramps between coefficient sets when smoothing is switched on
+    ChainCoefficientSmoother chainSmoother;
+    std::atomic<int> smoothingInterval {0};
+    // How long a smoothed transition to newly designed coefficients takes
+    static constexpr double smoothingTimeSeconds = 0.02;
+    
+    // Finished coefficient sets, written by the design side and picked up by process
+    TripleBuffer<ChainCoefficients> chainCoefficientsBuffer;
+    // Serialises the design side (setSettings vs. prepare), and guards the members below it
+    std::mutex designLock;
+    ChainSettings settings;
+    bool hasSettings = false;
+    ChainCoefficients designedCoefficients;
+    std::atomic<double> designSampleRate {0.0};
+    
+    // Applies a coefficient set to the chain that's processing. The other precision's chain is left...
+    // ...alone: switching precision goes through prepare, which republishes a full set (and jumps to it).
+    template<typename SampleType>
+    void applyToChain(const ChainCoefficients& chainCoefficients)
+    {
+        applyChainCoefficients(getChain<SampleType>().chain, chainCoefficients);
+    }
+    
+    // Designs the given bands from the stored settings and publishes the result. designLock must be held.
+    void designAndPublish(int bandsToDesign)
+    {
+        const auto rate = designSampleRate.load();
+        // Nothing to design for until prepare has told us the sample rate
+        if ( rate <= 0.0 || ! hasSettings || bandsToDesign == 0 )
+            return;
+        
+        updateChainCoefficients(designedCoefficients, settings, rate, bandsToDesign);
+        
+        chainCoefficientsBuffer.getWriteBuffer() = designedCoefficients;
+        chainCoefficientsBuffer.publish();
+        
+        // Linear phase mode: a new FIR with the same magnitude response. The convolutions crossfade to it.
+        if ( linearPhaseKernelWanted.load() )
+        {
+            auto kernel = LinearPhaseConvolver::makeKernel(linearPhaseConvolver.getKernelLength(),
+                                                           linearPhaseConvolver.getKernelSampleRate(),
+                                                           [this, rate] (double frequency)
+                                                           {
+                                                               return getChainMagnitudeForFrequency(designedCoefficients, frequency, rate);
+                                                           });
+            linearPhaseConvolver.loadKernel(kernel);
+        }
+    }
+    
+    // New latency, new design rate and a full redesign for the current mode. designLock must be held.
+    void applyProcessingMode()
+    {
+        // Whatever was in the filters, oversamplers and convolutions belongs to the old mode
+        floatChain.reset();
+        doubleChain.reset();
+        linearPhaseConvolver.reset();
+        
+        // Publish a coefficient set for the new filter rate. The smoother jumps straight to it.
+        // The linear phase kernel takes its magnitude response from sections designed at the highest...
+        // ...oversampled rate, where the bilinear transform hasn't cramped anything below our Nyquist yet.
+        chainSmoother.reset();
+        linearPhaseKernelWanted.store(linearPhase);
+        designSampleRate.store(sampleRate * (double)(1 << (linearPhase ? maxOversamplingStages : oversamplingStages)));
+        designAndPublish(ALL_BANDS);
+    }
+    
+    template<typename SampleType>
+    void process(SampleType* const* channels, int numChannels, int numSamples)
+    {
+        juce::ScopedNoDenormals noDenormals;
+        
+        // Smoothing control rate in samples (0 = smoothing off)
+        const auto controlInterval = smoothingInterval.load();
+        
+        // Pick up the newest coefficient set from the design side (if there is one)
+        if ( auto* chainCoefficients = chainCoefficientsBuffer.acquire() )
+        {
+            auto rampLengthInTicks = controlInterval > 0 ? juce::jmax(1, juce::roundToInt(smoothingTimeSeconds * sampleRate / controlInterval))
+                                                         : 0;
+            chainSmoother.setTarget(*chainCoefficients, rampLengthInTicks);
+            
+            // Without smoothing, the new coefficients land at the start of this block
+            if ( ! chainSmoother.isSmoothing() )
+                applyToChain<SampleType>(chainSmoother.getCurrent());
+        }
+        
+        // Smoothing was switched off part way through a ramp: finish it now
+        if ( controlInterval == 0 && chainSmoother.isSmoothing() )
+            applyToChain<SampleType>(chainSmoother.skipToTarget());
+        
+        auto& chain = getChain<SampleType>();
+        
+        if ( linearPhase )
+        {
+            // The FIR replaces the whole IIR chain (and with it any oversampling)
+            linearPhaseConvolver.process(channels, numChannels, numSamples);
+        }
+        else if ( auto* oversampler = chain.getOversampler(oversamplingStages) )
+        {
+            // Up, filter at the higher rate, and back down. The control interval scales with the rate,...
+            // ...so the smoother still ticks at the same speed in real time.
+            juce::dsp::AudioBlock<SampleType> channelsBlock(channels, (size_t)numChannels, (size_t)numSamples);
+            auto oversampledBlock = oversampler->processSamplesUp(channelsBlock);
+            
+            const auto numOversampledChannels = juce::jmin(numChannels, (int)chain.oversampledChannels.size());
+            for (int channel=0; channel<numOversampledChannels; channel++)
+                chain.oversampledChannels[(size_t)channel] = oversampledBlock.getChannelPointer((size_t)channel);
+            
+            processChain(chain.chain, chain.oversampledChannels.data(), numOversampledChannels,
+                         (int)oversampledBlock.getNumSamples(), controlInterval << oversamplingStages);
+            
+            oversampler->processSamplesDown(channelsBlock);
+        }
+        else
+        {
+            processChain(chain.chain, channels, numChannels, numSamples, controlInterval);
+        }
+    }
+    
+    // Runs the chain over (possibly oversampled) channels, stepping the smoother every controlInterval samples
+    template<typename SampleType>
+    void processChain(MultiChannelCascade<SampleType>& chain, SampleType* const* channels,
+                      int numChannels, int numSamples, int controlInterval)
+    {
+        // While smoothing, split the block into control-rate chunks and step the coefficients before each one.
+        // Otherwise the whole block is processed in one go.
+        const auto chunkSize = chainSmoother.isSmoothing() ? controlInterval : numSamples;
+        
+        for (int start = 0; start < numSamples; start += chunkSize)
+        {
+            if ( chainSmoother.isSmoothing() )
+                applyToChain<SampleType>(chainSmoother.tick());
+            
+            // run every channel through the chain, several channels per pass
+            auto numChunkSamples = juce::jmin(chunkSize, numSamples - start);
+            chain.process(channels, numChannels, start, numChunkSamples);
+        }
+    }
+};
+
+EQEngine::EQEngine() : impl(std::make_unique<Impl>())
+{
+}
+
+EQEngine::~EQEngine() = default;
+
+void EQEngine::prepare(double sampleRate, int maximumBlockSize, int numChannels, bool doublePrecision)
+{
+    // The design side may be loading a kernel into the convolver right now
+    const std::lock_guard<std::mutex> designLock(impl->designLock);
+    
+    impl->sampleRate = sampleRate;
+    impl->doublePrecision = doublePrecision;
+    
+    // The other precision's chain gets no channels (and no coefficients: see applyToChain)
+    impl->floatChain.prepare(doublePrecision ? 0 : numChannels, maximumBlockSize);
+    impl->doubleChain.prepare(doublePrecision ? numChannels : 0, maximumBlockSize);
+    impl->linearPhaseConvolver.prepare(numChannels, maximumBlockSize, sampleRate);
+    
+    impl->applyProcessingMode();
+}
+
+void EQEngine::reset()
+{
+    impl->floatChain.reset();
+    impl->doubleChain.reset();
+    impl->linearPhaseConvolver.reset();
+}
+
+void EQEngine::setProcessingMode(int oversamplingStages, bool linearPhase)
+{
+    const std::lock_guard<std::mutex> designLock(impl->designLock);
+    
+    impl->linearPhase = linearPhase;
+    impl->oversamplingStages = linearPhase ? 0 : juce::jlimit(0, maxOversamplingStages, oversamplingStages);
+    // The convolutions (and their memory) only exist while linear phase is selected
+    impl->linearPhaseConvolver.setEnabled(linearPhase);
+    impl->applyProcessingMode();
+}
+
+int EQEngine::getLatencyInSamples() const
+{
+    if ( impl->linearPhase )
+        return impl->linearPhaseConvolver.getLatencyInSamples();
+    
+    return impl->doublePrecision ? impl->doubleChain.getLatencyInSamples(impl->oversamplingStages)
+                                 : impl->floatChain.getLatencyInSamples(impl->oversamplingStages);
+}
+
+void EQEngine::setSettings(const ChainSettings& settings, int bandsToUpdate)
+{
+    const std::lock_guard<std::mutex> designLock(impl->designLock);
+    
+    // The first settings ever seen are all new
+    if ( ! impl->hasSettings )
+        bandsToUpdate = ALL_BANDS;
+    
+    impl->settings = settings;
+    impl->hasSettings = true;
+    impl->designAndPublish(bandsToUpdate);
+}
+
+void EQEngine::setSmoothingInterval(int samplesPerControlTick)
+{
+    impl->smoothingInterval.store(juce::jmax(0, samplesPerControlTick));
+}
+
+void EQEngine::process(float* const* channels, int numChannels, int numSamples)
+{
+    impl->process(channels, numChannels, numSamples);
+}
+
+void EQEngine::process(double* const* channels, int numChannels, int numSamples)
+{
+    impl->process(channels, numChannels, numSamples);
+}
+
+double EQEngine::getFilterSampleRate() const
+{
+    return impl->designSampleRate.load();
+}
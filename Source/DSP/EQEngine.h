@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    EQEngine.h
+
+    The whole EQ as a plain C++ object: no JUCE types in the interface, so it
+    can be embedded anywhere. Source/DSP is the whole of it: compile its .cpp
+    files along with juce_dsp (and the modules that depends on), as the
+    plugin, the CLI and the benchmarks all do. No GUI modules, no plugin client.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "ChainSettings.h"
+
+#include <memory>
+
+// Low cut, peak and high cut over any number of channels of raw float or double buffers, with...
+// ...optional 2x/4x oversampling, a linear phase mode and coefficient smoothing.
+// This is exactly what the plugin runs: _3BandEQAudioProcessor is a thin wrapper that feeds it...
+// ...parameter values and hands it the host's buffers.
+//
+// Threads:
+//  - prepare() and setProcessingMode() allocate and reset state: never concurrently with process().
+//  - setSettings() designs filters (and in linear phase mode, an FIR): any thread except the audio...
+//    ...thread. The finished design is handed to process() without locks or allocation.
+//  - process() is allocation and lock free.
+// e.g.
+//     EQEngine eq;
+//     eq.prepare(48000.0, 512, 2);
+//     eq.setSettings(settings);
+//     eq.process(channels, 2, numSamples);     // per block
+class EQEngine
+{
+public:
+    EQEngine();
+    ~EQEngine();
+    
+    // Allocates! Blocks may be up to maximumBlockSize samples long. Only the process() overload...
+    // ...matching doublePrecision gets buffers. Any settings given so far are designed for the new rate.
+    void prepare(double sampleRate, int maximumBlockSize, int numChannels, bool doublePrecision = false);
+    
+    // Clears all filter, oversampler and convolution state
+    void reset();
+    
+    // Oversampling as a number of 2x stages (0 to maxOversamplingStages), or the linear phase FIR...
+    // ...instead of the IIR chain (which ignores the oversampling). Resets and redesigns everything,...
+    // ...and changes the latency. Never concurrently with process().
+    void setProcessingMode(int oversamplingStages, bool linearPhase);
+    
+    // Latency of the current processing mode, in samples at the prepared rate
+    int getLatencyInSamples() const;
+    
+    // Designs filters for these settings and hands them to the audio thread. Not on the audio thread.
+    // Only the bands in bandsToUpdate (a BandMask) are redesigned; pass just the ones that changed.
+    // Before prepare() the settings are only stored.
+    void setSettings(const ChainSettings& settings, int bandsToUpdate = ALL_BANDS);
+    
+    // Coefficient smoothing: samples per control tick, or 0 for none (new designs land at the next...
+    // ...block boundary). Any thread.
+    void setSmoothingInterval(int samplesPerControlTick);
+    
+    // Filters the first numChannels channels in place. Audio thread.
+    void process(float* const* channels, int numChannels, int numSamples);
+    void process(double* const* channels, int numChannels, int numSamples);
+    
+    // The rate the filter coefficients are designed for: the sample rate times the oversampling...
+    // ...factor (in linear phase mode, the rate the FIR's magnitude response is taken from)
+    double getFilterSampleRate() const;
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+    
+    EQEngine(const EQEngine&) = delete;
+    EQEngine& operator=(const EQEngine&) = delete;
+};
@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    LinearPhaseConvolver.cpp
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseConvolver.h"
+
+void LinearPhaseConvolver::prepare(int numChannels, int maximumBlockSize, double sampleRate)
+{
+    kernelSampleRate = sampleRate;
+    kernelLength = juce::jlimit(minKernelLength, maxKernelLength, juce::nextPowerOfTwo(juce::roundToInt(sampleRate / 3.0)));
+    numChannelsPrepared = numChannels;
+    maximumBlockSizePrepared = maximumBlockSize;
+
+    if ( enabled )
+        createConvolutions();
+}
+
+void LinearPhaseConvolver::setEnabled(bool shouldBeEnabled)
+{
+    if ( shouldBeEnabled == enabled )
+        return;
+    enabled = shouldBeEnabled;
+
+    if ( enabled )
+    {
+        createConvolutions();
+    }
+    else
+    {
+        // Linear phase off: give back the partitions, the kernels and the scratch buffer
+        convolutions.clear();
+        floatBuffer.setSize(0, 0);
+    }
+}
+
+void LinearPhaseConvolver::createConvolutions()
+{
+    convolutions.clear();
+    for (int firstChannel=0; firstChannel<numChannelsPrepared; firstChannel += 2)
+    {
+        auto convolution = std::make_unique<juce::dsp::Convolution>(juce::dsp::Convolution::Latency { kernelLength / partitionsPerKernel },
+                                                                    *messageQueue);
+
+        juce::dsp::ProcessSpec spec;
+        spec.sampleRate = kernelSampleRate;
+        spec.maximumBlockSize = (juce::uint32)maximumBlockSizePrepared;
+        spec.numChannels = (juce::uint32)juce::jmin(2, numChannelsPrepared - firstChannel);
+        convolution->prepare(spec);
+
+        convolutions.push_back(std::move(convolution));
+    }
+
+    floatBuffer.setSize(numChannelsPrepared, maximumBlockSizePrepared);
+}
+
+void LinearPhaseConvolver::reset()
+{
+    for (auto& convolution : convolutions)
+        convolution->reset();
+}
+
+int LinearPhaseConvolver::getLatencyInSamples() const
+{
+    auto partitionLatency = convolutions.empty() ? kernelLength / partitionsPerKernel
+                                                 : convolutions.front()->getLatency();
+    return partitionLatency + kernelLength / 2;
+}
+
+void LinearPhaseConvolver::loadKernel(const juce::AudioBuffer<float>& kernel)
+{
+    for (auto& convolution : convolutions)
+    {
+        convolution->loadImpulseResponse(juce::AudioBuffer<float>(kernel),
+                                         kernelSampleRate,
+                                         juce::dsp::Convolution::Stereo::no,
+                                         juce::dsp::Convolution::Trim::no,
+                                         juce::dsp::Convolution::Normalise::no);
+    }
+}
+
+void LinearPhaseConvolver::processFloat(float* const* channels, int numChannels, int numSamples)
+{
+    juce::dsp::AudioBlock<float> block(channels, (size_t)numChannels, (size_t)numSamples);
+
+    for (size_t i=0; i<convolutions.size(); i++)
+    {
+        const auto firstChannel = (int)i * 2;
+        if ( firstChannel >= numChannels )
+            break;
+
+        auto pairBlock = block.getSubsetChannelBlock((size_t)firstChannel, (size_t)juce::jmin(2, numChannels - firstChannel));
+        juce::dsp::ProcessContextReplacing<float> context(pairBlock);
+        convolutions[i]->process(context);
+    }
+}
@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    LinearPhaseConvolver.h
+
+    Linear phase version of the EQ: a symmetric FIR built from the chain's
+    magnitude response, run through uniformly partitioned FFT convolution.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <memory>
+#include <vector>
+
+// Runs every channel through one linear phase FIR kernel.
+// The convolution is juce::dsp::Convolution with a fixed latency, which makes it a uniformly...
+// ...partitioned FFT convolution. The partition size is a fixed fraction of the kernel length...
+// ...(kernelLength / partitionsPerKernel), so the number of partitions stays constant and the cost per...
+// ...sample grows with log(kernel length) rather than with the kernel length itself.
+// Loading a new kernel is safe from any thread; the convolutions crossfade to it on their own.
+// The convolutions only exist while linear phase is switched on (setEnabled), and every instance of...
+// ...the plugin shares one background thread for loading kernels into them.
+struct LinearPhaseConvolver
+{
+    static constexpr int minKernelLength = 4096;
+    static constexpr int maxKernelLength = 32768;
+    static constexpr int partitionsPerKernel = 4;
+
+    // The kernel length follows the sample rate: about a third of a second, which keeps the bins a...
+    // ...few Hz apart, so a 20 Hz low cut still has a proper shape.
+    // Only allocates if enabled (the convolutions are rebuilt for the new format).
+    void prepare(int numChannels, int maximumBlockSize, double sampleRate);
+    void reset();
+    
+    // Allocates! Builds the convolutions (and prepares them for the format given to prepare), or frees...
+    // ...them. Not while process is running.
+    void setEnabled(bool shouldBeEnabled);
+    bool isEnabled() const { return enabled; }
+
+    int getKernelLength() const { return kernelLength; }
+    double getKernelSampleRate() const { return kernelSampleRate; }
+
+    // Partitioning latency plus the kernel's own delay (its centre tap)
+    int getLatencyInSamples() const;
+
+    // Any thread, but not at the same time as setEnabled or prepare. Hands a copy of the kernel to...
+    // ...every channel pair's convolution (or does nothing, if disabled).
+    void loadKernel(const juce::AudioBuffer<float>& kernel);
+
+    // Builds a linear phase kernel of 'length' taps for 'sampleRate' whose magnitude response is...
+    // ...magnitudeAt(frequency in Hz). Allocates and runs an FFT: keep it off the audio thread.
+    template<typename MagnitudeFunction>
+    static juce::AudioBuffer<float> makeKernel(int length, double sampleRate, MagnitudeFunction&& magnitudeAt)
+    {
+        // Zero phase spectrum: the magnitude alone, for bins 0 to length / 2...
+        std::vector<float> data((size_t)length * 2, 0.f);
+        for (int bin=0; bin<=length / 2; bin++)
+            data[(size_t)bin * 2] = (float)magnitudeAt((double)bin * sampleRate / (double)length);
+
+        // ...back to an impulse response centred on sample 0 (JUCE mirrors the negative frequencies)
+        juce::dsp::FFT fft(juce::roundToInt(std::log2((double)length)));
+        fft.performRealOnlyInverseTransform(data.data());
+
+        // Rotate the centre to length / 2 and taper the ends with a Blackman window centred there too
+        juce::AudioBuffer<float> kernel(1, length);
+        auto* taps = kernel.getWritePointer(0);
+        for (int i=0; i<length; i++)
+        {
+            const auto phase = juce::MathConstants<double>::twoPi * (double)i / (double)length;
+            const auto window = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase);
+            taps[i] = data[(size_t)((i + length / 2) % length)] * (float)window;
+        }
+        return kernel;
+    }
+
+    // Processes numChannels channels in place
+    template<typename SampleType>
+    void process(SampleType* const* channels, int numChannels, int numSamples)
+    {
+        if constexpr (std::is_same<SampleType, float>::value)
+        {
+            processFloat(channels, numChannels, numSamples);
+        }
+        else
+        {
+            // juce::dsp::Convolution is float only: go through the scratch buffer, a buffer's worth at...
+            // ...a time (blocks longer than prepare's maximum still get all of their samples convolved)
+            const auto chunkSize = floatBuffer.getNumSamples();
+            
+            // There are only convolutions for the channels prepare was given
+            jassert(numChannels <= floatBuffer.getNumChannels());
+            numChannels = juce::jmin(numChannels, floatBuffer.getNumChannels());
+            if ( chunkSize == 0 )
+                return;
+            
+            for (int start=0; start<numSamples; start += chunkSize)
+            {
+                const auto numInChunk = juce::jmin(chunkSize, numSamples - start);
+                
+                for (int channel=0; channel<numChannels; channel++)
+                {
+                    auto* destination = floatBuffer.getWritePointer(channel);
+                    for (int i=0; i<numInChunk; i++)
+                        destination[i] = (float)channels[channel][start + i];
+                }
+                
+                processFloat(floatBuffer.getArrayOfWritePointers(), numChannels, numInChunk);
+                
+                for (int channel=0; channel<numChannels; channel++)
+                {
+                    auto* source = floatBuffer.getReadPointer(channel);
+                    for (int i=0; i<numInChunk; i++)
+                        channels[channel][start + i] = (SampleType)source[i];
+                }
+            }
+        }
+    }
+private:
+    void processFloat(float* const* channels, int numChannels, int numSamples);
+    // Allocates: builds and prepares the convolutions for the current format
+    void createConvolutions();
+
+    // Loads new kernels in the background for every instance's convolutions. Declared before them,...
+    // ...so it outlives them.
+    juce::SharedResourcePointer<juce::dsp::ConvolutionMessageQueue> messageQueue;
+
+    // One per pair of channels (juce::dsp::Convolution handles mono or stereo); a mono kernel is...
+    // ...applied to both channels of a pair
+    std::vector<std::unique_ptr<juce::dsp::Convolution>> convolutions;
+    juce::AudioBuffer<float> floatBuffer;
+    double kernelSampleRate = 0.0;
+    int kernelLength = minKernelLength;
+    int numChannelsPrepared = 0;
+    int maximumBlockSizePrepared = 0;
+    bool enabled = false;
+};
@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    OversampledChain.h
+
+    The channel cascade plus the oversamplers that can wrap it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "ChainSettings.h"
+#include "BiquadCascade.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+// The channel cascade for one sample type, plus the 2x and 4x oversamplers that can wrap it.
+// Bilinear transform biquads get cramped near Nyquist (a high cut or peak up there can't reach the...
+// ...shape it would have in the analog domain); running the cascade at 2x or 4x the host rate moves...
+// ...Nyquist out of the way. The up/down sampling uses JUCE's polyphase half-band IIR stages, the...
+// ...cheapest option it has, with latency rounded up to a whole number of samples so it can be reported.
+template<typename SampleType>
+struct OversampledChain
+{
+    // Allocates! Both oversamplers are built up front, so switching between them never allocates.
+    // With numChannels == 0 nothing is allocated and the chain only tracks coefficients.
+    void prepare(int numChannels, int maximumBlockSize)
+    {
+        // Oversampled blocks are longer: size the chain for the longest so it never has to split them
+        chain.prepare(numChannels, maximumBlockSize << maxOversamplingStages);
+        oversampledChannels.assign((size_t)numChannels, nullptr);
+        
+        for (size_t stages=1; stages<oversamplers.size(); stages++)
+        {
+            oversamplers[stages].reset();
+            if ( numChannels > 0 )
+            {
+                oversamplers[stages] = std::make_unique<juce::dsp::Oversampling<SampleType>>((size_t)numChannels,
+                                                                                           stages,
+                                                                                           juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR,
+                                                                                           false,   // max quality?
+                                                                                           true);   // integer latency?
+                oversamplers[stages]->initProcessing((size_t)maximumBlockSize);
+            }
+        }
+    }
+    
+    void reset()
+    {
+        chain.reset();
+        for (auto& oversampler : oversamplers)
+            if ( oversampler != nullptr )
+                oversampler->reset();
+    }
+    
+    // The oversampler for this many 2x stages, or nullptr (no oversampling, or not prepared)
+    juce::dsp::Oversampling<SampleType>* getOversampler(int stages) const
+    {
+        return stages > 0 ? oversamplers[(size_t)stages].get() : nullptr;
+    }
+    
+    int getLatencyInSamples(int stages) const
+    {
+        auto* oversampler = getOversampler(stages);
+        return oversampler != nullptr ? juce::roundToInt(oversampler->getLatencyInSamples()) : 0;
+    }
+    
+    MultiChannelCascade<SampleType> chain;
+    // Scratch list of the oversampled block's channels, in the form the chain wants
+    std::vector<SampleType*> oversampledChannels;
+private:
+    // Indexed by number of 2x stages ([0] is unused: no oversampling)
+    std::array<std::unique_ptr<juce::dsp::Oversampling<SampleType>>, maxOversamplingStages + 1> oversamplers;
+};
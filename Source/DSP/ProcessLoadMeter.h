@@ -0,0 +1,222 @@
+/*
+  ==============================================================================
+
+    ProcessLoadMeter.h
+
+    How much of each block's realtime budget processBlock used: a wait-free
+    histogram written by the audio thread and read from anywhere.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+// The cheapest monotonic counter around: a couple of clock_gettime calls per block would cost more...
+// ...than the rest of the recording put together
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+ #define EQ_LOAD_METER_TSC 1
+ #if defined(_MSC_VER)
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#elif defined(__aarch64__)
+ #define EQ_LOAD_METER_CNTVCT 1
+#endif
+
+// Load = wall clock time spent in one processBlock call, as a percentage of that block's duration...
+// ...(numSamples / sampleRate). Over 100% is an overrun: that block took longer than it lasts.
+// Loads go into a log-spaced histogram (8 bins per octave, 0.001% to 2048%), so p99 is exact to...
+// ...within a bin (about 9%); min, max and mean are exact.
+// Only the audio thread writes, so every update is a plain relaxed store: no locks, no...
+// ...read-modify-writes. Readers may see a block half recorded, which is fine for statistics.
+struct ProcessLoadMeter
+{
+    struct Statistics
+    {
+        std::uint64_t numBlocks = 0;
+        std::uint64_t numOverruns = 0;
+        float minPercent = 0.f;
+        float meanPercent = 0.f;
+        float p99Percent = 0.f;
+        float maxPercent = 0.f;
+    };
+    
+    // Times the scope it lives in (put it first thing in processBlock)
+    struct ScopedMeasurement
+    {
+        ScopedMeasurement(ProcessLoadMeter& meterToUse, int numSamplesInBlock) :
+            meter(meterToUse), numSamples(numSamplesInBlock), start(readTicks()) { }
+        ~ScopedMeasurement() { meter.record(readTicks() - start, numSamples); }
+    private:
+        ProcessLoadMeter& meter;
+        int numSamples;
+        std::uint64_t start;
+    };
+    
+    // Sets the rate block budgets are worked out from, and starts the statistics over. Call before...
+    // ...processing starts, not while it's running.
+    void prepare(double sampleRate)
+    {
+        percentPerTickSample = 100.0 * sampleRate / getTicksPerSecond();
+        scaleNumSamples = 0;
+        reset();
+    }
+    
+    // Audio thread: one block of numSamples took 'ticks'
+    void record(std::uint64_t ticks, int numSamples)
+    {
+        if ( numSamples <= 0 || percentPerTickSample <= 0.0 )
+            return;
+        
+        if ( resetRequested.load(std::memory_order_relaxed) )
+            clear();
+        
+        // Hosts nearly always use the same block size, so the scale is only worked out when it changes
+        if ( numSamples != scaleNumSamples )
+        {
+            scaleNumSamples = numSamples;
+            percentPerTick = (float)(percentPerTickSample / numSamples);
+        }
+        const auto load = (float)ticks * percentPerTick;
+        auto& bin = bins[(size_t)getBin(load)];
+        bin.store(bin.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        
+        const auto count = numBlocks.load(std::memory_order_relaxed);
+        sum.store(sum.load(std::memory_order_relaxed) + load, std::memory_order_relaxed);
+        if ( count == 0 || load < minimum.load(std::memory_order_relaxed) )
+            minimum.store(load, std::memory_order_relaxed);
+        if ( load > maximum.load(std::memory_order_relaxed) )
+            maximum.store(load, std::memory_order_relaxed);
+        if ( load > 100.f )
+            overruns.store(overruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        
+        numBlocks.store(count + 1, std::memory_order_release);
+    }
+    
+    // Any thread
+    Statistics getStatistics() const
+    {
+        Statistics statistics;
+        if ( resetRequested.load(std::memory_order_acquire) )
+            return statistics;
+        
+        statistics.numBlocks = numBlocks.load(std::memory_order_acquire);
+        if ( statistics.numBlocks == 0 )
+            return statistics;
+        
+        statistics.numOverruns = overruns.load(std::memory_order_relaxed);
+        statistics.minPercent = minimum.load(std::memory_order_relaxed);
+        statistics.maxPercent = maximum.load(std::memory_order_relaxed);
+        statistics.meanPercent = (float)(sum.load(std::memory_order_relaxed) / (double)statistics.numBlocks);
+        
+        // Walk down from the top until more than 1% of the blocks are above: p99 is that bin's upper edge...
+        // ...(but never past the true maximum)
+        const auto slowest = statistics.numBlocks / 100;
+        std::uint64_t above = 0;
+        for (int i = numBins - 1; i >= 0; i--)
+        {
+            above += bins[(size_t)i].load(std::memory_order_relaxed);
+            if ( above > slowest )
+            {
+                statistics.p99Percent = std::min(getBinUpperEdge(i), statistics.maxPercent);
+                break;
+            }
+        }
+        return statistics;
+    }
+    
+    // Any thread: the audio thread clears everything at its next block
+    void reset() { resetRequested.store(true, std::memory_order_release); }
+    
+    // Raw counter, and its rate (the TSC's is measured against steady_clock once, on first use)
+    static std::uint64_t readTicks()
+    {
+       #if EQ_LOAD_METER_TSC
+        return (std::uint64_t)__rdtsc();
+       #elif EQ_LOAD_METER_CNTVCT
+        std::uint64_t ticks;
+        asm volatile ("mrs %0, cntvct_el0" : "=r" (ticks));
+        return ticks;
+       #else
+        return (std::uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+       #endif
+    }
+    
+    static double getTicksPerSecond()
+    {
+       #if EQ_LOAD_METER_TSC
+        // Assumes an invariant TSC (every x86 CPU of the last decade or so)
+        static const double ticksPerSecond = []
+        {
+            using Clock = std::chrono::steady_clock;
+            const auto clockStart = Clock::now();
+            const auto tickStart = readTicks();
+            while ( Clock::now() - clockStart < std::chrono::milliseconds(5) ) { }
+            const auto ticks = readTicks() - tickStart;
+            return (double)ticks / std::chrono::duration<double>(Clock::now() - clockStart).count();
+        }();
+        return ticksPerSecond;
+       #elif EQ_LOAD_METER_CNTVCT
+        std::uint64_t frequency;
+        asm volatile ("mrs %0, cntfrq_el0" : "=r" (frequency));
+        return (double)frequency;
+       #else
+        using Period = std::chrono::steady_clock::period;
+        return (double)Period::den / (double)Period::num;
+       #endif
+    }
+private:
+    // Bins are the top 3 mantissa bits plus the exponent of the load as a float, offset so 2^-10 % is bin 0
+    static constexpr std::uint32_t binShift = 20;
+    static constexpr std::uint32_t firstBinBits = (127u - 10u) << (23 - binShift);
+    static constexpr int numBins = 21 * 8;
+    
+    static int getBin(float load)
+    {
+        load = std::min(std::max(load, 1.f / 1024.f), 2047.f);
+        std::uint32_t bits;
+        std::memcpy(&bits, &load, sizeof(bits));
+        return std::min((int)((bits >> binShift) - firstBinBits), numBins - 1);
+    }
+    
+    static float getBinUpperEdge(int bin)
+    {
+        const std::uint32_t bits = ((std::uint32_t)bin + 1 + firstBinBits) << binShift;
+        float edge;
+        std::memcpy(&edge, &bits, sizeof(edge));
+        return edge;
+    }
+    
+    // Audio thread, on a pending reset
+    void clear()
+    {
+        for (auto& bin : bins)
+            bin.store(0, std::memory_order_relaxed);
+        sum.store(0.0, std::memory_order_relaxed);
+        minimum.store(0.f, std::memory_order_relaxed);
+        maximum.store(0.f, std::memory_order_relaxed);
+        overruns.store(0, std::memory_order_relaxed);
+        numBlocks.store(0, std::memory_order_relaxed);
+        resetRequested.store(false, std::memory_order_release);
+    }
+    
+    double percentPerTickSample = 0.0;
+    // Audio thread only: percentPerTickSample divided by the last block size
+    int scaleNumSamples = 0;
+    float percentPerTick = 0.f;
+    std::array<std::atomic<std::uint32_t>, numBins> bins {};
+    std::atomic<std::uint64_t> numBlocks {0};
+    std::atomic<std::uint64_t> overruns {0};
+    std::atomic<double> sum {0.0};
+    std::atomic<float> minimum {0.f};
+    std::atomic<float> maximum {0.f};
+    std::atomic<bool> resetRequested {false};
+};
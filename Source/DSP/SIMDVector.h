@@ -0,0 +1,298 @@
+/*
+  ==============================================================================
+
+    SIMDVector.h
+
+    Tiny fixed-width SIMD wrapper used by the biquad cascades, where each lane
+    carries one audio channel.
+
+    Native widths: 2 and 4 floats on SSE2 and NEON, 2 doubles on SSE2 and
+    64-bit NEON, plus 8 floats / 4 doubles when the build targets AVX (-mavx,
+    /arch:AVX). Everything else falls back to plain arrays.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #define EQ_SIMD_SSE 1
+ #include <emmintrin.h>
+ #if defined(__AVX__)
+  #define EQ_SIMD_AVX 1
+  #include <immintrin.h>
+ #endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+ #define EQ_SIMD_NEON 1
+ #include <arm_neon.h>
+#endif
+
+// Generic version: plain arrays, for platforms (or widths) without a native specialisation.
+// Only the handful of operations the cascades need are provided.
+template<typename SampleType, int Lanes>
+struct SIMDVector
+{
+    static constexpr int NumLanes = Lanes;
+
+    static SIMDVector broadcast(SampleType value)
+    {
+        SIMDVector v;
+        v.lanes.fill(value);
+        return v;
+    }
+
+    // Load NumLanes contiguous values / store them back
+    static SIMDVector fromLanes(const SampleType* values)
+    {
+        SIMDVector v;
+        for (int i=0; i<NumLanes; i++)
+            v.lanes[i] = values[i];
+        return v;
+    }
+
+    void toLanes(SampleType* values) const
+    {
+        for (int i=0; i<NumLanes; i++)
+            values[i] = lanes[i];
+    }
+
+    friend SIMDVector operator+ (SIMDVector a, const SIMDVector& b) { for (int i=0; i<NumLanes; i++) a.lanes[i] += b.lanes[i]; return a; }
+    friend SIMDVector operator- (SIMDVector a, const SIMDVector& b) { for (int i=0; i<NumLanes; i++) a.lanes[i] -= b.lanes[i]; return a; }
+    friend SIMDVector operator* (SIMDVector a, const SIMDVector& b) { for (int i=0; i<NumLanes; i++) a.lanes[i] *= b.lanes[i]; return a; }
+
+    // Same rule as JUCE's util::snapToZero: anything within +/-1e-8 becomes exactly 0
+    SIMDVector snappedToZero() const
+    {
+        SIMDVector v = *this;
+        for (auto& lane : v.lanes)
+            if ( ! (lane < (SampleType)-1.0e-8 || lane > (SampleType)1.0e-8) )
+                lane = 0;
+        return v;
+    }
+
+    std::array<SampleType, NumLanes> lanes;
+};
+
+#if EQ_SIMD_SSE
+// Two float lanes (e.g. left and right) in the bottom half of an SSE register
+template<>
+struct SIMDVector<float, 2>
+{
+    static constexpr int NumLanes = 2;
+
+    static SIMDVector broadcast(float value)            { return { _mm_set1_ps(value) }; }
+    static SIMDVector fromLanes(const float* values)    { return { _mm_setr_ps(values[0], values[1], 0.f, 0.f) }; }
+    void toLanes(float* values) const                   { _mm_storel_pi(reinterpret_cast<__m64*>(values), value); }
+
+    friend SIMDVector operator+ (SIMDVector a, SIMDVector b) { return { _mm_add_ps(a.value, b.value) }; }
+    friend SIMDVector operator- (SIMDVector a, SIMDVector b) { return { _mm_sub_ps(a.value, b.value) }; }
+    friend SIMDVector operator* (SIMDVector a, SIMDVector b) { return { _mm_mul_ps(a.value, b.value) }; }
+
+    SIMDVector snappedToZero() const
+    {
+        const auto threshold = _mm_set1_ps(1.0e-8f);
+        const auto keep = _mm_or_ps(_mm_cmplt_ps(value, _mm_sub_ps(_mm_setzero_ps(), threshold)),
+                                    _mm_cmpgt_ps(value, threshold));
+        return { _mm_and_ps(value, keep) };
+    }
+
+    __m128 value;
+};
+
+// Four float lanes in an SSE register
+template<>
+struct SIMDVector<float, 4>
+{
+    static constexpr int NumLanes = 4;
+
+    static SIMDVector broadcast(float value)            { return { _mm_set1_ps(value) }; }
+    static SIMDVector fromLanes(const float* values)    { return { _mm_loadu_ps(values) }; }
+    void toLanes(float* values) const                   { _mm_storeu_ps(values, value); }
+
+    friend SIMDVector operator+ (SIMDVector a, SIMDVector b) { return { _mm_add_ps(a.value, b.value) }; }
+    friend SIMDVector operator- (SIMDVector a, SIMDVector b) { return { _mm_sub_ps(a.value, b.value) }; }
+    friend SIMDVector operator* (SIMDVector a, SIMDVector b) { return { _mm_mul_ps(a.value, b.value) }; }
+
+    SIMDVector snappedToZero() const
+    {
+        const auto threshold = _mm_set1_ps(1.0e-8f);
+        const auto keep = _mm_or_ps(_mm_cmplt_ps(value, _mm_sub_ps(_mm_setzero_ps(), threshold)),
+                                    _mm_cmpgt_ps(value, threshold));
+        return { _mm_and_ps(value, keep) };
+    }
+
+    __m128 value;
+};
+
+ #if EQ_SIMD_AVX
+// Eight float lanes in an AVX register
+template<>
+struct SIMDVector<float, 8>
+{
+    static constexpr int NumLanes = 8;
+
+    static SIMDVector broadcast(float value)            { return { _mm256_set1_ps(value) }; }
+    static SIMDVector fromLanes(const float* values)    { return { _mm256_loadu_ps(values) }; }
+    void toLanes(float* values) const                   { _mm256_storeu_ps(values, value); }
+
+    friend SIMDVector operator+ (SIMDVector a, SIMDVector b) { return { _mm256_add_ps(a.value, b.value) }; }
+    friend SIMDVector operator- (SIMDVector a, SIMDVector b) { return { _mm256_sub_ps(a.value, b.value) }; }
+    friend SIMDVector operator* (SIMDVector a, SIMDVector b) { return { _mm256_mul_ps(a.value, b.value) }; }
+
+    SIMDVector snappedToZero() const
+    {
+        const auto threshold = _mm256_set1_ps(1.0e-8f);
+        const auto keep = _mm256_or_ps(_mm256_cmp_ps(value, _mm256_sub_ps(_mm256_setzero_ps(), threshold), _CMP_LT_OQ),
+                                       _mm256_cmp_ps(value, threshold, _CMP_GT_OQ));
+        return { _mm256_and_ps(value, keep) };
+    }
+
+    __m256 value;
+};
+ #endif
+
+// Two double lanes in an SSE2 register
+template<>
+struct SIMDVector<double, 2>
+{
+    static constexpr int NumLanes = 2;
+
+    static SIMDVector broadcast(double value)           { return { _mm_set1_pd(value) }; }
+    static SIMDVector fromLanes(const double* values)   { return { _mm_loadu_pd(values) }; }
+    void toLanes(double* values) const                  { _mm_storeu_pd(values, value); }
+
+    friend SIMDVector operator+ (SIMDVector a, SIMDVector b) { return { _mm_add_pd(a.value, b.value) }; }
+    friend SIMDVector operator- (SIMDVector a, SIMDVector b) { return { _mm_sub_pd(a.value, b.value) }; }
+    friend SIMDVector operator* (SIMDVector a, SIMDVector b) { return { _mm_mul_pd(a.value, b.value) }; }
+
+    SIMDVector snappedToZero() const
+    {
+        const auto threshold = _mm_set1_pd(1.0e-8);
+        const auto keep = _mm_or_pd(_mm_cmplt_pd(value, _mm_sub_pd(_mm_setzero_pd(), threshold)),
+                                    _mm_cmpgt_pd(value, threshold));
+        return { _mm_and_pd(value, keep) };
+    }
+
+    __m128d value;
+};
+
+ #if EQ_SIMD_AVX
+// Four double lanes in an AVX register
+template<>
+struct SIMDVector<double, 4>
+{
+    static constexpr int NumLanes = 4;
+
+    static SIMDVector broadcast(double value)           { return { _mm256_set1_pd(value) }; }
+    static SIMDVector fromLanes(const double* values)   { return { _mm256_loadu_pd(values) }; }
+    void toLanes(double* values) const                  { _mm256_storeu_pd(values, value); }
+
+    friend SIMDVector operator+ (SIMDVector a, SIMDVector b) { return { _mm256_add_pd(a.value, b.value) }; }
+    friend SIMDVector operator- (SIMDVector a, SIMDVector b) { return { _mm256_sub_pd(a.value, b.value) }; }
+    friend SIMDVector operator* (SIMDVector a, SIMDVector b) { return { _mm256_mul_pd(a.value, b.value) }; }
+
+    SIMDVector snappedToZero() const
+    {
+        const auto threshold = _mm256_set1_pd(1.0e-8);
+        const auto keep = _mm256_or_pd(_mm256_cmp_pd(value, _mm256_sub_pd(_mm256_setzero_pd(), threshold), _CMP_LT_OQ),
+                                       _mm256_cmp_pd(value, threshold, _CMP_GT_OQ));
+        return { _mm256_and_pd(value, keep) };
+    }
+
+    __m256d value;
+};
+ #endif
+#elif EQ_SIMD_NEON
+// Two float lanes (e.g. left and right) in a 64-bit NEON register
+template<>
+struct SIMDVector<float, 2>
+{
+    static constexpr int NumLanes = 2;
+
+    static SIMDVector broadcast(float value)            { return { vdup_n_f32(value) }; }
+    static SIMDVector fromLanes(const float* values)    { return { vld1_f32(values) }; }
+    void toLanes(float* values) const                   { vst1_f32(values, value); }
+
+    friend SIMDVector operator+ (SIMDVector a, SIMDVector b) { return { vadd_f32(a.value, b.value) }; }
+    friend SIMDVector operator- (SIMDVector a, SIMDVector b) { return { vsub_f32(a.value, b.value) }; }
+    friend SIMDVector operator* (SIMDVector a, SIMDVector b) { return { vmul_f32(a.value, b.value) }; }
+
+    SIMDVector snappedToZero() const
+    {
+        const auto threshold = vdup_n_f32(1.0e-8f);
+        const auto keep = vorr_u32(vclt_f32(value, vneg_f32(threshold)), vcgt_f32(value, threshold));
+        return { vreinterpret_f32_u32(vand_u32(vreinterpret_u32_f32(value), keep)) };
+    }
+
+    float32x2_t value;
+};
+
+// Four float lanes in a 128-bit NEON register
+template<>
+struct SIMDVector<float, 4>
+{
+    static constexpr int NumLanes = 4;
+
+    static SIMDVector broadcast(float value)            { return { vdupq_n_f32(value) }; }
+    static SIMDVector fromLanes(const float* values)    { return { vld1q_f32(values) }; }
+    void toLanes(float* values) const                   { vst1q_f32(values, value); }
+
+    friend SIMDVector operator+ (SIMDVector a, SIMDVector b) { return { vaddq_f32(a.value, b.value) }; }
+    friend SIMDVector operator- (SIMDVector a, SIMDVector b) { return { vsubq_f32(a.value, b.value) }; }
+    friend SIMDVector operator* (SIMDVector a, SIMDVector b) { return { vmulq_f32(a.value, b.value) }; }
+
+    SIMDVector snappedToZero() const
+    {
+        const auto threshold = vdupq_n_f32(1.0e-8f);
+        const auto keep = vorrq_u32(vcltq_f32(value, vnegq_f32(threshold)), vcgtq_f32(value, threshold));
+        return { vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(value), keep)) };
+    }
+
+    float32x4_t value;
+};
+
+ #if defined(__aarch64__) || defined(_M_ARM64)
+// Two double lanes in a 128-bit NEON register (64-bit ARM only)
+template<>
+struct SIMDVector<double, 2>
+{
+    static constexpr int NumLanes = 2;
+
+    static SIMDVector broadcast(double value)           { return { vdupq_n_f64(value) }; }
+    static SIMDVector fromLanes(const double* values)   { return { vld1q_f64(values) }; }
+    void toLanes(double* values) const                  { vst1q_f64(values, value); }
+
+    friend SIMDVector operator+ (SIMDVector a, SIMDVector b) { return { vaddq_f64(a.value, b.value) }; }
+    friend SIMDVector operator- (SIMDVector a, SIMDVector b) { return { vsubq_f64(a.value, b.value) }; }
+    friend SIMDVector operator* (SIMDVector a, SIMDVector b) { return { vmulq_f64(a.value, b.value) }; }
+
+    SIMDVector snappedToZero() const
+    {
+        const auto threshold = vdupq_n_f64(1.0e-8);
+        const auto keep = vorrq_u64(vcltq_f64(value, vnegq_f64(threshold)), vcgtq_f64(value, threshold));
+        return { vreinterpretq_f64_u64(vandq_u64(vreinterpretq_u64_f64(value), keep)) };
+    }
+
+    float64x2_t value;
+};
+  #define EQ_SIMD_NEON_DOUBLE 1
+ #endif
+#endif
+
+// The widest native vector of each type on this build: how many channels one register can carry
+#if EQ_SIMD_AVX
+ static constexpr int widestFloatVectorLanes = 8;
+ static constexpr int widestDoubleVectorLanes = 4;
+#elif EQ_SIMD_SSE || EQ_SIMD_NEON_DOUBLE
+ static constexpr int widestFloatVectorLanes = 4;
+ static constexpr int widestDoubleVectorLanes = 2;
+#elif EQ_SIMD_NEON
+ static constexpr int widestFloatVectorLanes = 4;
+ static constexpr int widestDoubleVectorLanes = 1;
+#else
+ static constexpr int widestFloatVectorLanes = 1;
+ static constexpr int widestDoubleVectorLanes = 1;
+#endif
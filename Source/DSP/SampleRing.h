@@ -0,0 +1,156 @@
+/*
+  ==============================================================================
+
+    SampleRing.h
+
+    Single producer / single consumer ring of raw float samples, several
+    channels wide, written and read in bulk.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// The audio thread writes whole blocks (memcpy for float, one conversion pass for double); the...
+// ...consumer reads however many samples it wants, or skips ahead. Each channel is a power of two...
+// ...long so wrapping is a mask, and the read/write positions only ever count up (64 bits won't...
+// ...wrap), so full and empty can't be confused.
+// A block that doesn't fit is dropped whole, not cut short, and counted (getNumDroppedSamples), so...
+// ...the consumer never sees a block's head without its tail.
+// Neither side allocates or locks. prepare() may allocate, and like reset() mustn't run while either...
+// ...side is busy.
+struct MultiChannelSampleRing
+{
+    // At least minimumCapacity samples per channel (rounded up to a power of two). Only reallocates...
+    // ...if the channel count or capacity changes; otherwise it's just a reset.
+    void prepare(int numChannelsToUse, int minimumCapacity)
+    {
+        int newCapacity = 1;
+        while ( newCapacity < minimumCapacity )
+            newCapacity <<= 1;
+        
+        const auto newNumChannels = std::max(1, numChannelsToUse);
+        if ( newNumChannels != numChannels || newCapacity != capacity )
+        {
+            numChannels = newNumChannels;
+            capacity = newCapacity;
+            mask = (std::uint64_t)(capacity - 1);
+            storage.assign((size_t)(numChannels * capacity), 0.f);
+        }
+        reset();
+    }
+    
+    // Forgets everything (call it when neither side is busy, like prepare)
+    void reset()
+    {
+        writePosition.store(0, std::memory_order_relaxed);
+        readPosition.store(0, std::memory_order_relaxed);
+        numDropped.store(0, std::memory_order_relaxed);
+    }
+    
+    int getNumChannels() const { return numChannels; }
+    int getCapacity() const { return capacity; }
+    
+    //==============================================================================
+    // Producer: appends numSamples of every channel (channels[i] for ring channel i). Returns false,...
+    // ...and writes nothing, if there isn't room for all of it.
+    template<typename SampleType>
+    bool write(const SampleType* const* channels, int numSamples)
+    {
+        const auto write = writePosition.load(std::memory_order_relaxed);
+        const auto read = readPosition.load(std::memory_order_acquire);
+        
+        if ( numSamples <= 0 || numSamples > capacity - (int)(write - read) )
+        {
+            if ( numSamples > 0 )
+                numDropped.store(numDropped.load(std::memory_order_relaxed) + (std::uint64_t)numSamples, std::memory_order_relaxed);
+            return false;
+        }
+        
+        // At most two runs: up to the end of the ring, then from its start
+        const auto start = (int)(write & mask);
+        const auto firstRun = std::min(numSamples, capacity - start);
+        for (int channel = 0; channel < numChannels; channel++)
+        {
+            auto* destination = storage.data() + channel * capacity;
+            copySamples(destination + start, channels[channel], firstRun);
+            copySamples(destination, channels[channel] + firstRun, numSamples - firstRun);
+        }
+        
+        writePosition.store(write + (std::uint64_t)numSamples, std::memory_order_release);
+        return true;
+    }
+    
+    //==============================================================================
+    // Consumer: samples ready to read (per channel)
+    int getNumReady() const
+    {
+        return (int)(writePosition.load(std::memory_order_acquire) - readPosition.load(std::memory_order_relaxed));
+    }
+    
+    // Consumer: copies up to numSamples of every channel into destinations[i] and consumes them. Returns...
+    // ...how many it copied.
+    int read(float* const* destinations, int numSamples)
+    {
+        const auto read = readPosition.load(std::memory_order_relaxed);
+        numSamples = std::min(numSamples, getNumReady());
+        if ( numSamples <= 0 )
+            return 0;
+        
+        const auto start = (int)(read & mask);
+        const auto firstRun = std::min(numSamples, capacity - start);
+        for (int channel = 0; channel < numChannels; channel++)
+        {
+            const auto* source = storage.data() + channel * capacity;
+            std::memcpy(destinations[channel], source + start, (size_t)firstRun * sizeof(float));
+            std::memcpy(destinations[channel] + firstRun, source, (size_t)(numSamples - firstRun) * sizeof(float));
+        }
+        
+        readPosition.store(read + (std::uint64_t)numSamples, std::memory_order_release);
+        return numSamples;
+    }
+    
+    // Consumer: throws away up to numSamples without copying them. Returns how many it skipped.
+    int skip(int numSamples)
+    {
+        numSamples = std::min(numSamples, getNumReady());
+        if ( numSamples <= 0 )
+            return 0;
+        
+        readPosition.store(readPosition.load(std::memory_order_relaxed) + (std::uint64_t)numSamples, std::memory_order_release);
+        return numSamples;
+    }
+    
+    // Samples the producer had to drop because the consumer fell behind (since prepare/reset)
+    std::uint64_t getNumDroppedSamples() const { return numDropped.load(std::memory_order_relaxed); }
+private:
+    template<typename SampleType>
+    static void copySamples(float* destination, const SampleType* source, int numSamples)
+    {
+        if constexpr ( std::is_same_v<SampleType, float> )
+        {
+            std::memcpy(destination, source, (size_t)numSamples * sizeof(float));
+        }
+        else
+        {
+            for (int i = 0; i < numSamples; i++)
+                destination[i] = (float)source[i];
+        }
+    }
+    
+    int numChannels = 1;
+    int capacity = 0;
+    std::uint64_t mask = 0;
+    std::vector<float> storage;
+    
+    std::atomic<std::uint64_t> writePosition {0};
+    std::atomic<std::uint64_t> readPosition {0};
+    std::atomic<std::uint64_t> numDropped {0};
+};
@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    TripleBuffer.h
+
+    Wait-free snapshot handoff between one producer thread and one consumer thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+
+// Three copies of T: one owned by the producer, one owned by the consumer, and one "in the middle".
+// The producer fills getWriteBuffer() and calls publish(), which swaps its buffer into the middle.
+// The consumer calls acquire(), which swaps the middle buffer out only if something new was published.
+// Neither side ever blocks, waits or allocates, so either end can safely live on the audio thread.
+template<typename T>
+struct TripleBuffer
+{
+    // Producer side: the buffer to fill before calling publish()
+    T& getWriteBuffer() { return buffers[writeIndex]; }
+
+    // Producer side: make the write buffer visible to the consumer
+    void publish()
+    {
+        auto previousMiddle = middle.exchange(writeIndex | FreshBit, std::memory_order_acq_rel);
+        writeIndex = previousMiddle & IndexMask;
+    }
+
+    // Consumer side: returns the newest published snapshot, or nullptr if nothing new has arrived
+    const T* acquire()
+    {
+        if ( (middle.load(std::memory_order_relaxed) & FreshBit) == 0 )
+            return nullptr;
+
+        auto previousMiddle = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previousMiddle & IndexMask;
+        return &buffers[readIndex];
+    }
+
+    // Consumer side: the most recently acquired snapshot
+    const T& getReadBuffer() const { return buffers[readIndex]; }
+private:
+    static constexpr int IndexMask = 3;
+    static constexpr int FreshBit = 4;
+
+    std::array<T, 3> buffers {};
+    int writeIndex = 0;
+    int readIndex = 1;
+    std::atomic<int> middle {2};
+};
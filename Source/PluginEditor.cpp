@@ -266,133 +266,236 @@ juce::String RotarySliderWithLabels::getDisplayString() const
 
 ResponseCurve::ResponseCurve(_3BandEQAudioProcessor& audioProcessor) :
 audioProcessor(audioProcessor),
-leftChannelPathGenerator(audioProcessor.leftChannelFIFO),
-rightChannelPathGenerator(audioProcessor.rightChannelFIFO)
+analyzerWorker(audioProcessor)
 {
-    // Tell our Listener to listen to the main audio processor chain parameters
-    const auto& parameters = audioProcessor.getParameters();
-    for (auto parameter : parameters)
-    {
-        parameter->addListener(this);
-    }
-    
-    // Update the response curve audio chain once to begin with
+    // Design the response curve's coefficients once to begin with
+    chainVersions = audioProcessor.chainParameters.getVersions();
     updateChain();
     
     // Start the timer, update GUI at 60Hz refresh rate
     startTimerHz(60);
 }
 
-ResponseCurve::~ResponseCurve()
+//==============================================================================
+
+AnalyzerWorker::AnalyzerWorker(_3BandEQAudioProcessor& p) : audioProcessor(p)
 {
-    // Tell our Listener to stop listening to the main audio processor chain parameters
-    const auto& parameters = audioProcessor.getParameters();
-    for (auto parameter : parameters)
-    {
-        parameter->removeListener(this);
-    }
+    analyzerOverlapParameter = audioProcessor.APVTS.getRawParameterValue("Analyzer_Overlap");
+    analyzerOrderParameter = audioProcessor.APVTS.getRawParameterValue("Analyzer_Order");
+    
+    // Room for the most pullAnalyzerInput ever reads at once (under a window plus a hop of the...
+    // ...biggest FFT), so it never has to grow
+    analyzerInput.setSize(2, (1 << ORDER_8192) + (1 << ORDER_8192) / 2);
+    
+    analyzerThread->addTimeSliceClient(this);
 }
 
-void ResponseCurve::parameterValueChanged(int parameterIndex, float newValue)
+AnalyzerWorker::~AnalyzerWorker()
 {
-    // raise our atomic flag
-    parametersChanged.set(true);
+    // Waits for useTimeSlice to finish if it's running, so after this nothing else touches the tap
+    analyzerThread->removeTimeSliceClient(this);
+    
+    if ( subscribed )
+        audioProcessor.unsubscribeFromAnalyzer();
 }
 
-void PathGenerator::process(juce::Rectangle<float> fftBounds, double sampleRate)
+void AnalyzerWorker::setBounds(juce::Rectangle<float> newBounds)
 {
-    // While there are buffers to pull,
-    // if we can pull a buffer,
-    // send it to the FFT data generator
-    juce::AudioBuffer<float> tempIncomingBuffer;
-    while ( leftChannelFIFO->getNumCompleteBuffersAvailable() > 0 )
+    const juce::SpinLock::ScopedLockType lock(boundsLock);
+    bounds = newBounds;
+}
+
+int AnalyzerWorker::useTimeSlice()
+{
+    // Follow the analyzer being switched on and off
+    const auto shouldBeSubscribed = enabled.load();
+    if ( shouldBeSubscribed != subscribed )
     {
-        if ( leftChannelFIFO->getAudioBuffer(tempIncomingBuffer) )
+        subscribed = shouldBeSubscribed;
+        if ( subscribed )
         {
-            // Shift mono buffer over by the number of samples in tempIncomingBuffer
-            auto numIncomingSamples = tempIncomingBuffer.getNumSamples();
-            juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, 0),
-                                              monoBuffer.getReadPointer(0, numIncomingSamples),
-                                              monoBuffer.getNumSamples() - numIncomingSamples);
-            
-            // Copy the samples from our tempIncomingBuffer to the end of our mono buffer
-            juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, monoBuffer.getNumSamples() - numIncomingSamples),
-                                              tempIncomingBuffer.getReadPointer(0, 0),
-                                              numIncomingSamples);
-            
-            // Send mono buffer to FFT data generator
-            leftChannelFFTDataGenerator.produceFFTDataForRendering(monoBuffer, -48.f);
+            // Whatever the windows held is from before the gap: start them from silence
+            leftChannelPathGenerator.reset();
+            rightChannelPathGenerator.reset();
+            audioProcessor.subscribeToAnalyzer();
+        }
+        else
+        {
+            audioProcessor.unsubscribeFromAnalyzer();
         }
     }
     
-    // If there are FFT data buffers to pull, and we can pull a buffer,
-    // generate a path
-    const auto fftSize = leftChannelFFTDataGenerator.getFFTSize();
-    // Bin width is...
-    // 48000 samples per second / 2048 fft samples = 23 Hz
-    const auto binWidth = sampleRate / (double)fftSize;
+    // About the display's frame rate: more often would only make frames nobody sees
+    constexpr int frameIntervalMs = 1000 / 60;
+    if ( ! subscribed )
+        return frameIntervalMs;
+    
+    // (only does anything when the choice has changed)
+    const auto order = (FFTOrder)(ORDER_2048 + juce::jlimit(0, 2, (int)analyzerOrderParameter->load()));
+    leftChannelPathGenerator.requestOrder(order);
+    rightChannelPathGenerator.requestOrder(order);
     
-    while (leftChannelFFTDataGenerator.getNumAvailableFFTDataBlocks() > 0)
+    if ( ! pullAnalyzerInput() )
+        return frameIntervalMs;
+    
+    juce::Rectangle<float> fftBounds;
     {
-        std::vector<float> fftData;
-        if (leftChannelFFTDataGenerator.getFFTData(fftData))
-        {
-            pathGenerator.generatePath(fftData,
-                                       fftBounds,
-                                       fftSize,
-                                       binWidth,
-                                       -48.f);
-        }
+        const juce::SpinLock::ScopedLockType lock(boundsLock);
+        fftBounds = bounds;
     }
+    auto sampleRate = audioProcessor.getSampleRate();
+    
+    // Straight into the frame the message thread gets next: no copies
+    auto& frame = frames.getWriteBuffer();
+    const auto numLeftColumns = leftChannelPathGenerator.process(fftBounds, sampleRate, frame.left.data(), AnalyzerFrame::maxColumns);
+    const auto numRightColumns = rightChannelPathGenerator.process(fftBounds, sampleRate, frame.right.data(), AnalyzerFrame::maxColumns);
+    // (they only differ, by a column or so at Nyquist, while the two channels change FFT size)
+    frame.numColumns = juce::jmin(numLeftColumns, numRightColumns);
+    if ( frame.numColumns > 0 )
+        frames.publish();
     
-    // While there are paths that can be pulled,
-    //  pull as many as we can
-    // Only display the most recent path
-    while (pathGenerator.getNumPathsAvailable())
+    return frameIntervalMs;
+}
+
+void PathGenerator::pushSamples(const float* samples, int numSamples)
+{
+    // More than a whole window's worth: only the newest samples matter
+    if ( numSamples > monoBuffer.getNumSamples() )
     {
-        pathGenerator.getPath(leftChannelFFTPath);
+        samples += numSamples - monoBuffer.getNumSamples();
+        numSamples = monoBuffer.getNumSamples();
     }
+    
+    // Shift mono buffer over by the number of incoming samples
+    juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, 0),
+                                      monoBuffer.getReadPointer(0, numSamples),
+                                      monoBuffer.getNumSamples() - numSamples);
+    
+    // Copy the incoming samples to the end of our mono buffer
+    juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, monoBuffer.getNumSamples() - numSamples),
+                                      samples,
+                                      numSamples);
+}
+
+void PathGenerator::reset()
+{
+    monoBuffer.clear();
+}
+
+int PathGenerator::process(juce::Rectangle<float> fftBounds, double sampleRate, float* columnYs, int maxColumns)
+{
+    // Pull every FFT data buffer waiting, but only draw the most recent one
+    bool hasNewData = false;
+    while ( leftChannelFFTDataGenerator.getFFTData(fftData) )
+        hasNewData = true;
+    
+    if ( ! hasNewData )
+        return 0;
+    
+    // The FFT size this frame was made with (it can change from one frame to the next)
+    const auto fftSize = (int)fftData.size() / 2;
+    // Bin width is...
+    // 48000 samples per second / 2048 fft samples = 23 Hz
+    const auto binWidth = sampleRate / (double)fftSize;
+    
+    return columnGenerator.generateColumns(fftData,
+                                           fftBounds,
+                                           fftSize,
+                                           (float)binWidth,
+                                           -48.f,
+                                           columnYs,
+                                           maxColumns);
 }
 
 void ResponseCurve::timerCallback()
 {
-    // If analyzer is NOT bypassed,
-    if ( isFFTAnalysisEnabled )
-    {
-        auto fftBounds = getAnalysisArea().toFloat();
-        auto sampleRate = audioProcessor.getSampleRate();
-        leftChannelPathGenerator.process(fftBounds, sampleRate);
-        rightChannelPathGenerator.process(fftBounds, sampleRate);
-    }
+    // If analyzer is NOT bypassed, pick up the newest frame the worker has finished
+    bool needsRepaint = isFFTAnalysisEnabled && analyzerWorker.acquireFrame();
     
     // if parameters have been changed since the last timer tick...
-    // ...lower the flag and update the Editor mono chain
-    if (parametersChanged.compareAndSetBool(false, true))
+    // ...update just those bands of the Editor mono chain
+    auto versions = audioProcessor.chainParameters.getVersions();
+    auto changedBands = ChainParameterRegistry::getChangedBands(versions, chainVersions);
+    // ...or all of them if the filters now run at a different rate (e.g. oversampling was switched)
+    if ( audioProcessor.getFilterSampleRate() != chainSampleRate )
+        changedBands = ALL_BANDS;
+    if ( changedBands != 0 )
     {
+        chainVersions = versions;
         // update the response curve's audio chain
-        updateChain();
+        updateChain(changedBands);
+        needsRepaint = true;
     }
     
-    repaint();
+    if ( needsRepaint )
+        repaint();
+}
+
+bool AnalyzerWorker::pullAnalyzerInput()
+{
+    // Frames are a fixed hop apart, whatever size blocks the host uses. Only whole hops are taken...
+    // ...from the ring; the rest waits for the next tick.
+    // prepareToPlay is resetting the ring: leave it alone until next tick
+    const juce::SpinLock::ScopedTryLockType lock(audioProcessor.analyzerRingLock);
+    if ( ! lock.isLocked() )
+        return false;
+    
+    auto& ring = audioProcessor.analyzerRing;
+    const auto fftSize = leftChannelPathGenerator.getFFTSize();
+    const auto overlapIndex = juce::jlimit(0, 2, (int)analyzerOverlapParameter->load());
+    const auto hopSize = fftSize >> (overlapIndex + 1);
+    
+    auto numToRead = (ring.getNumReady() / hopSize) * hopSize;
+    if ( numToRead == 0 )
+        return false;
+    
+    // Only the newest frame gets drawn, so one FFT per tick is all the display can use: skip the whole...
+    // ...hops that would fall out of the window anyway, and analyse just the latest one
+    if ( numToRead > fftSize )
+    {
+        const auto numToSkip = ((numToRead - fftSize) / hopSize) * hopSize;
+        ring.skip(numToSkip);
+        numToRead -= numToSkip;
+    }
+    
+    // At most one FFT's worth is left by now, and the constructor sized analyzerInput for the biggest FFT
+    jassert(numToRead <= analyzerInput.getNumSamples());
+    
+    ring.read(analyzerInput.getArrayOfWritePointers(), numToRead);
+    leftChannelPathGenerator.pushSamples(analyzerInput.getReadPointer(0), numToRead);
+    rightChannelPathGenerator.pushSamples(analyzerInput.getReadPointer(1), numToRead);
+    leftChannelPathGenerator.produceFrame();
+    rightChannelPathGenerator.produceFrame();
+    return true;
+}
+
+void ResponseCurve::updateChain(int bandsToUpdate)
+{
+    auto sampleRate = audioProcessor.getFilterSampleRate();
+    // Nothing sensible to draw until the processor has been prepared
+    if ( sampleRate <= 0.0 )
+        return;
+    chainSampleRate = sampleRate;
+    
+    // redesign just the bands that changed (paint reads the curve straight off the coefficients)
+    updateChainCoefficients(chainCoefficients,
+                            audioProcessor.chainParameters.getChainSettings(),
+                            sampleRate,
+                            bandsToUpdate);
 }
 
-void ResponseCurve::updateChain()
+// One vertical run per pixel column, from the previous column's y to this one's: a connected 1px...
+// ...line, with no Path to build, copy or stroke
+void ResponseCurve::drawAnalyzerTrace(juce::Graphics& g, const float* columnYs, int numColumns, juce::Point<int> origin)
 {
-    auto chainSettings = getChainSettings(audioProcessor.APVTS);
-    
-    // update bypass settings
-    monoChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypass);
-    monoChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypass);
-    monoChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypass);
-    // update peak filter
-    auto peakCoefficients = makePeakFilter(chainSettings, audioProcessor.getSampleRate());
-    updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    // update low cut filter
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, audioProcessor.getSampleRate());
-    updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, chainSettings.lowCutSlope);
-    // update high cut filter
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
-    updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, chainSettings.highCutSlope);
+    for (int x = 0; x < numColumns; x++)
+    {
+        const auto y = columnYs[x];
+        const auto previousY = x > 0 ? columnYs[x - 1] : y;
+        g.drawVerticalLine(origin.x + x,
+                           origin.y + juce::jmin(y, previousY),
+                           origin.y + juce::jmax(y, previousY) + 1.f);
+    }
 }
 
 void ResponseCurve::paint (juce::Graphics& g)
@@ -408,11 +511,8 @@ void ResponseCurve::paint (juce::Graphics& g)
     auto responseArea = getAnalysisArea();
     auto width = responseArea.getWidth();
     
-    auto& peakFilter = monoChain.get<ChainPositions::Peak>();
-    auto& lowCutFilter = monoChain.get<ChainPositions::LowCut>();
-    auto& highCutFilter = monoChain.get<ChainPositions::HighCut>();
-    
-    auto sampleRate = audioProcessor.getSampleRate();
+    // The rate the chain's coefficients were designed for (none yet: draw a flat line)
+    auto sampleRate = chainSampleRate;
     
     // Magnitudes as doubles representing Gain (multiplicative)
     std::vector<double> magnitudes;
@@ -424,37 +524,9 @@ void ResponseCurve::paint (juce::Graphics& g)
         // calculate corresponding frequency for this pixel
         auto freq = mapToLog10(double(i) / double(width), 20.0, 20000.0);
         
-        // start with unity gain
-        double magnitude = 1.f;
-        // multiply the magnitude value by the resulting gain at this frequency...
-        // ...from each non-bypassed filter in our processing chain
-        // Peak Filter
-        if (! monoChain.isBypassed<ChainPositions::Peak>())
-            magnitude *= peakFilter.coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        // Low Cut Filter
-        if (! monoChain.isBypassed<ChainPositions::LowCut>() )
-        {
-            if (! lowCutFilter.isBypassed<0>())
-                magnitude *= lowCutFilter.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (! lowCutFilter.isBypassed<1>())
-                magnitude *= lowCutFilter.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (! lowCutFilter.isBypassed<2>())
-                magnitude *= lowCutFilter.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (! lowCutFilter.isBypassed<3>())
-                magnitude *= lowCutFilter.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
-        // High Cut Filter
-        if (! monoChain.isBypassed<ChainPositions::HighCut>() )
-        {
-            if (! highCutFilter.isBypassed<0>())
-                magnitude *= highCutFilter.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (! highCutFilter.isBypassed<1>())
-                magnitude *= highCutFilter.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (! highCutFilter.isBypassed<2>())
-                magnitude *= highCutFilter.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (! highCutFilter.isBypassed<3>())
-                magnitude *= highCutFilter.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        }
+        // multiply together the gain at this frequency of every section that runs in our chain
+        double magnitude = sampleRate > 0.0 ? getChainMagnitudeForFrequency(chainCoefficients, freq, sampleRate)
+                                            : 1.0;
         
         // Convert gain to decibels
         magnitudes[i] = Decibels::gainToDecibels(magnitude);
@@ -482,16 +554,13 @@ void ResponseCurve::paint (juce::Graphics& g)
     // If analyzer is NOT bypassed, draw the FFT analysis curve
     if ( isFFTAnalysisEnabled )
     {
-        // Draw left channel FFT analyzer path
-        auto leftChannelFFTPath = leftChannelPathGenerator.getPath();
-        leftChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY()));
+        auto& frame = analyzerWorker.getFrame();
+        // Draw left channel FFT analyzer trace
         g.setColour(Colours::brown);
-        g.strokePath(leftChannelFFTPath, PathStrokeType(1.f));
-        // Draw right channel FFT analyzer path
-        auto rightChannelFFTPath = rightChannelPathGenerator.getPath();
-        rightChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY()));
+        drawAnalyzerTrace(g, frame.left.data(), frame.numColumns, responseArea.getPosition());
+        // Draw right channel FFT analyzer trace
         g.setColour(Colours::maroon);
-        g.strokePath(rightChannelFFTPath, PathStrokeType(1.f));
+        drawAnalyzerTrace(g, frame.right.data(), frame.numColumns, responseArea.getPosition());
     }
 
     // draw rounded rectangle border.
@@ -524,6 +593,8 @@ void ResponseCurve::resized()
     
     // Get render area info, cache it for the upcoming calcs
     auto renderArea = getAnalysisArea();
+    // The analyzer's paths are built (in the background) to fit the same area
+    analyzerWorker.setBounds(renderArea.toFloat());
     auto left = renderArea.getX();
     auto right = renderArea.getRight();
     auto top = renderArea.getY();
@@ -651,6 +722,47 @@ juce::Rectangle<int> ResponseCurve::getAnalysisArea()
     return bounds;
 }
 
+//==============================================================================
+
+LoadMeterOverlay::LoadMeterOverlay(_3BandEQAudioProcessor& p) : audioProcessor(p)
+{
+    // The statistics only move once per block: a few refreshes a second is plenty
+    startTimerHz(4);
+}
+
+void LoadMeterOverlay::timerCallback()
+{
+    const auto statistics = audioProcessor.getLoadStatistics();
+    
+    auto newText = statistics.numBlocks == 0
+        ? juce::String("CPU --")
+        : "CPU " + juce::String(statistics.meanPercent, 1) + "% avg  "
+                 + juce::String(statistics.p99Percent, 1) + "% p99  "
+                 + juce::String(statistics.maxPercent, 1) + "% max  "
+                 + juce::String((juce::int64)statistics.numOverruns) + " overruns";
+    
+    if ( newText != text )
+    {
+        text = newText;
+        hasOverruns = statistics.numOverruns > 0;
+        repaint();
+    }
+}
+
+void LoadMeterOverlay::paint(juce::Graphics& g)
+{
+    using namespace juce;
+    
+    g.setColour(hasOverruns ? Colours::darkred : Colours::black.withAlpha(0.6f));
+    g.setFont(11);
+    g.drawFittedText(text, getLocalBounds(), Justification::centredRight, 1);
+}
+
+void LoadMeterOverlay::mouseDown(const juce::MouseEvent&)
+{
+    audioProcessor.resetLoadStatistics();
+}
+
 //==============================================================================
 //  Class Definition
 //==============================================================================
@@ -659,6 +771,7 @@ _3BandEQAudioProcessorEditor::_3BandEQAudioProcessorEditor (_3BandEQAudioProcess
 AudioProcessorEditor (&p), audioProcessor (p),
 
 responseCurve(audioProcessor),
+loadMeterOverlay(audioProcessor),
 
 peakFreqSlider(*audioProcessor.APVTS.getParameter("Peak_Freq"), "Hz"),
 peakGainSlider(*audioProcessor.APVTS.getParameter("Peak_Gain"), "dB"),
@@ -676,10 +789,16 @@ lowCutSlopeSliderAttachment(audioProcessor.APVTS, "LowCut_Slope", lowCutSlopeSli
 highCutFreqSliderAttachment(audioProcessor.APVTS, "HighCut_Freq", highCutFreqSlider),
 highCutSlopeSliderAttachment(audioProcessor.APVTS, "HighCut_Slope", highCutSlopeSlider),
 
+analyzerOverlapBox(*audioProcessor.APVTS.getParameter("Analyzer_Overlap")),
+analyzerOrderBox(*audioProcessor.APVTS.getParameter("Analyzer_Order")),
+
 lowCutBypassButtonAttachment(audioProcessor.APVTS, "LowCut_Bypass", lowCutBypassButton),
 highCutBypassButtonAttachment(audioProcessor.APVTS, "HighCut_Bypass", highCutBypassButton),
 peakBypassButtonAttachment(audioProcessor.APVTS, "Peak_Bypass", peakBypassButton),
-analyzerBypassButtonAttachment(audioProcessor.APVTS, "Analyzer_Bypass", analyzerBypassButton)
+analyzerBypassButtonAttachment(audioProcessor.APVTS, "Analyzer_Bypass", analyzerBypassButton),
+
+analyzerOverlapBoxAttachment(audioProcessor.APVTS, "Analyzer_Overlap", analyzerOverlapBox),
+analyzerOrderBoxAttachment(audioProcessor.APVTS, "Analyzer_Order", analyzerOrderBox)
 {
     // Define min/max value labels for our rotary sliders
     peakFreqSlider.labels.add({0.f, "20 Hz"});
@@ -749,6 +868,8 @@ analyzerBypassButtonAttachment(audioProcessor.APVTS, "Analyzer_Bypass", analyzer
             juceComp->responseCurve.setFFTAnalysisEnabled( enabled );
         }
     };
+    // ...and start it off in whatever state the parameter is in
+    responseCurve.setFFTAnalysisEnabled(analyzerBypassButton.getToggleState());
     
     
     // Set the plugin window size
@@ -786,6 +907,15 @@ void _3BandEQAudioProcessorEditor::resized()
     analyzerBypassArea.removeFromTop(2);
     analyzerBypassButton.setBounds(analyzerBypassArea);
     
+    // Analyzer settings next to its button
+    auto analyzerSettingsArea = analyzerBypassArea.withX(analyzerBypassArea.getRight() + 5).withWidth(70);
+    analyzerOrderBox.setBounds(analyzerSettingsArea);
+    analyzerSettingsArea.setX(analyzerSettingsArea.getRight() + 5);
+    analyzerOverlapBox.setBounds(analyzerSettingsArea);
+    
+    // Load readout on the rest of the top strip
+    loadMeterOverlay.setBounds(getLocalBounds().removeFromTop(25).withTrimmedLeft(analyzerSettingsArea.getRight() + 5).reduced(5, 2));
+    
     bounds.removeFromTop(5);
     
     float heightRatio = 25.f / 100.f;
@@ -830,6 +960,10 @@ std::vector<juce::Component*> _3BandEQAudioProcessorEditor::getComponents()
         &lowCutBypassButton,
         &highCutBypassButton,
         &peakBypassButton,
-        &analyzerBypassButton
+        &analyzerBypassButton,
+        &analyzerOverlapBox,
+        &analyzerOrderBox,
+        
+        &loadMeterOverlay
     };
 }
@@ -10,6 +10,9 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "Fifo.h"
+#include "DSP/TripleBuffer.h"
+#include "DSP/FastDecibels.h"
 
 enum FFTOrder
 {
@@ -18,90 +21,207 @@ enum FFTOrder
     ORDER_8192 = 13
 };
 
+// Background thread shared by every FFTDataGenerator, for building the FFTs they switch to
+struct FFTPlanThread : juce::TimeSliceThread
+{
+    FFTPlanThread() : juce::TimeSliceThread("3BandEQ FFT Plans")
+    {
+        startThread();
+    }
+    
+    ~FFTPlanThread() override
+    {
+        stopThread(1000);
+    }
+};
+
 // This class generates FFT data from an audio buffer
 template<typename BlockType>
 struct FFTDataGenerator
 {
-    void produceFFTDataForRendering(const juce::AudioBuffer<float>& audioData, const float negativeInf)
+    // Runs an FFT over the newest getFFTSize() samples of the history (which must be at least that long)
+    void produceFFTDataForRendering(const float* history, int historyLength, const float negativeInf)
     {
+        // A new FFT size may have been built in the meantime: switch to it from this frame on
+        installPendingPlan();
+        
         const auto fftSize = getFFTSize();
+        jassert(historyLength >= fftSize);
+        auto& fftData = plan->fftData;
         
-        fftData.assign(fftData.size(), 0);
-        auto* readIndex = audioData.getReadPointer(0);
+        // Nothing needs clearing first: the transform only reads the first fftSize values, which this...
+        // ...overwrites, and only the first numBins of its output are ever looked at
+        auto* readIndex = history + historyLength - fftSize;
         std::copy(readIndex, readIndex + fftSize, fftData.begin());
         
         // First apply a windowing function to our data
-        window->multiplyWithWindowingTable( fftData.data(), fftSize );
+        plan->window.multiplyWithWindowingTable( fftData.data(), (size_t)fftSize );
         // then render our FFT data
-        forwardFFT->performFrequencyOnlyForwardTransform( fftData.data() );
+        plan->forwardFFT.performFrequencyOnlyForwardTransform( fftData.data() );
         
         int numBins = (int)fftSize / 2;
         
-        // Normalize FFT values
-        for (int i=0; i<numBins; i++)
-        {
-            fftData[i] /= (float)numBins;
-        }
-        
-        // Convert the FFT values to dB
-        for (int i=0; i<numBins; i++)
-        {
-            fftData[i] = juce::Decibels::gainToDecibels(fftData[i], negativeInf);
-        }
+        // Normalize the FFT values and convert them to dB, floored at negativeInf, in one pass
+        gainsToDecibels(fftData.data(), numBins, 1.f / (float)numBins, negativeInf);
         
         fftDataFIFO.push(fftData);
     }
     
+    // Builds the FFT, window and buffer for newOrder right here. For setting up, before any frames.
     void changeOrder(FFTOrder newOrder)
     {
-        // When FFT order is changed, recreate the window, forwardFFT, fifo, fftData
-        // and reset the fifoIndex
-        // Things that need recreating should be created on the heap via std::make_unique<>
-        order = newOrder;
-        auto fftSize = getFFTSize();
-        
-        forwardFFT = std::make_unique<juce::dsp::FFT>(order);
-        window = std::make_unique<juce::dsp::WindowingFunction<float>>(fftSize,
-                                                                       juce::dsp::WindowingFunction<float>::blackmanHarris);
+        plan = std::make_unique<Plan>(newOrder, ++latestGeneration);
+        requestedOrder = newOrder;
+        builder.markBuilt(newOrder, latestGeneration);
         
-        fftData.clear();
-        fftData.resize(fftSize * 2, 0);
-        
-        fftDataFIFO.prepare(fftData.size());
+        // Room for the biggest frames up front, so switching never reallocates the FIFO's slots
+        fftDataFIFO.prepare((size_t)(2 << ORDER_8192));
+    }
+    
+    // Switches to newOrder without holding anything up: the new FFT, window and buffer are built on the...
+    // ...FFTPlanThread, and the next frame after they're ready uses them. No frames are skipped.
+    void requestOrder(FFTOrder newOrder)
+    {
+        if ( newOrder == requestedOrder )
+            return;
+        requestedOrder = newOrder;
+        builder.request(newOrder, ++latestGeneration);
     }
     //======================================================================================
-    int getFFTSize() const { return 1 << order; }
+    int getFFTSize() const { return plan->getFFTSize(); }
     int getNumAvailableFFTDataBlocks() const { return fftDataFIFO.getNumAvailableForReading(); }
     //======================================================================================
+    // Frames are 2 * their FFT size long (the size they were made with may not be the current one)
     bool getFFTData(BlockType& fftData) { return fftDataFIFO.pull(fftData); }
 private:
-    FFTOrder order;
-    BlockType fftData;
-    std::unique_ptr<juce::dsp::FFT> forwardFFT;
-    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+    // Everything that depends on the FFT size
+    struct Plan
+    {
+        Plan(FFTOrder orderToUse, int generationToUse) :
+            order(orderToUse),
+            generation(generationToUse),
+            forwardFFT(orderToUse),
+            window((size_t)getFFTSize(), juce::dsp::WindowingFunction<float>::blackmanHarris)
+        {
+            fftData.resize((size_t)getFFTSize() * 2, 0);
+        }
+        
+        int getFFTSize() const { return 1 << order; }
+        
+        FFTOrder order;
+        int generation;
+        juce::dsp::FFT forwardFFT;
+        juce::dsp::WindowingFunction<float> window;
+        BlockType fftData;
+    };
+    
+    // Where background-built plans wait to be picked up
+    struct PlanHandoff
+    {
+        // Builder side: replaces whatever is waiting. The one it replaces was never taken, so nobody...
+        // ...else can be looking at it. (Whether a plan is newer than the one in use is up to...
+        // ...installPendingPlan: peeking at the waiting one here could race with take() deleting it.)
+        void offer(std::unique_ptr<Plan> newPlan)
+        {
+            delete pending.exchange(newPlan.release());
+        }
+        
+        std::unique_ptr<Plan> take() { return std::unique_ptr<Plan>(pending.exchange(nullptr)); }
+        
+        ~PlanHandoff() { delete pending.load(); }
+        
+        std::atomic<Plan*> pending { nullptr };
+    };
+    
+    // Builds the newest requested plan on the shared FFTPlanThread, one at a time, so they're...
+    // ...offered in the order they were asked for. It joins the thread at the first request, and...
+    // ...leaving it waits for a build that's under way, so nothing outlives the generator.
+    struct PlanBuilder : juce::TimeSliceClient
+    {
+        explicit PlanBuilder(PlanHandoff& handoffToUse) : handoff(handoffToUse) {}
+        
+        ~PlanBuilder() override
+        {
+            planThread->removeTimeSliceClient(this);
+        }
+        
+        // The order and its generation go in one atomic, so the builder never pairs one with the...
+        // ...other's neighbour
+        static int pack(FFTOrder order, int generation) { return (generation << 4) | (int)order; }
+        
+        // Owner side, before any requests (so before the thread can be looking): this one's already built
+        void markBuilt(FFTOrder order, int generation)
+        {
+            built = pack(order, generation);
+            requested.store(built);
+        }
+        
+        // Owner side: build this next (anything asked for before it and not started yet is skipped).
+        // Adding a client that's already there just brings its next call forward.
+        void request(FFTOrder order, int generation)
+        {
+            requested.store(pack(order, generation));
+            planThread->addTimeSliceClient(this);
+        }
+        
+        int useTimeSlice() override
+        {
+            const auto wanted = requested.load();
+            if ( wanted != built )
+            {
+                built = wanted;
+                handoff.offer(std::make_unique<Plan>((FFTOrder)(wanted & 15), wanted >> 4));
+            }
+            
+            // (request() brings the next call forward, so this is just a backstop)
+            return 500;
+        }
+        
+        PlanHandoff& handoff;
+        std::atomic<int> requested { 0 };
+        // Builder side: the last request built
+        int built = 0;
+        
+        juce::SharedResourcePointer<FFTPlanThread> planThread;
+    };
+    
+    void installPendingPlan()
+    {
+        // (plans arrive in the order they were asked for, but changeOrder may have replaced ours since)
+        if ( auto newPlan = handoff.take() )
+            if ( newPlan->generation > plan->generation )
+                std::swap(plan, newPlan);
+    }
+    
+    std::unique_ptr<Plan> plan;
+    FFTOrder requestedOrder;
+    int latestGeneration = 0;
+    PlanHandoff handoff;
     
     Fifo<BlockType> fftDataFIFO;
+    
+    // Last, so it's gone (and any build it was running has finished) before what it builds into
+    PlanBuilder builder { handoff };
 };
 
-// Generates a path from FFT data
-template<typename PathType>
-struct AnalyzerPathGenerator
+// Turns FFT data into the analyzer's trace: one y value per pixel column
+struct AnalyzerColumnGenerator
 {
-    // Converts renderData[] into a juce::Path
-    void generatePath(const std::vector<float>& renderData,
-                      juce::Rectangle<float> fftBounds,
-                      int fftSize,
-                      float binWidth,
-                      float negativeInf)
+    // Writes the trace's y in each pixel column, from 20Hz up to 20kHz (or Nyquist, if that's lower),...
+    // ...into columnYs, which has room for maxColumns. Returns how many columns it wrote.
+    int generateColumns(const std::vector<float>& renderData,
+                        juce::Rectangle<float> fftBounds,
+                        int fftSize,
+                        float binWidth,
+                        float negativeInf,
+                        float* columnYs,
+                        int maxColumns)
     {
         auto top = fftBounds.getY();
         auto bottom = fftBounds.getHeight();
-        auto width = fftBounds.getWidth();
         
-        int numBins = (int)fftSize / 2;
-        
-        PathType p;
-        p.preallocateSpace( 3 * (int)fftBounds.getWidth() );
+        // (only does anything when the width, sample rate or FFT size has changed)
+        updateColumns(juce::jmin((int)fftBounds.getWidth(), maxColumns), fftSize, binWidth);
         
         auto map = [bottom, top, negativeInf](float v)
         {
@@ -110,44 +230,90 @@ struct AnalyzerPathGenerator
                               float(bottom), top);
         };
         
-        auto y = map(renderData[0]);
+        // (FFTDataGenerator floors every bin at negativeInf, so there's no NaN or inf to check for)
+        for ( size_t x = 0; x < columns.size(); x++ )
+            columnYs[x] = map(getColumnLevel(renderData.data(), columns[x]));
+        
+        return (int)columns.size();
+    }
+private:
+    // The bins that land in one pixel column. At the low end, where bins are wider than a column, a...
+    // ...column can have none: then numBins is 0, and it interpolates between firstBin and the next bin.
+    struct Column
+    {
+        int firstBin = 0;
+        int numBins = 0;
+        float fraction = 0.f;
+    };
+    
+    // Loudest bin in the column (or the interpolated level, if it has none)
+    static float getColumnLevel(const float* renderData, const Column& column)
+    {
+        if ( column.numBins == 0 )
+        {
+            const auto below = renderData[column.firstBin];
+            return below + column.fraction * (renderData[column.firstBin + 1] - below);
+        }
         
-        jassert( !std::isnan(y) && !std::isinf(y) );
+        auto level = renderData[column.firstBin];
+        for (int i=1; i<column.numBins; i++)
+            level = juce::jmax(level, renderData[column.firstBin + i]);
+        return level;
+    }
+    
+    // Rebuilds the column table, if the width, bin width (sample rate) or FFT size has changed.
+    // Column x covers 20Hz..20kHz positions [x, x + 1) of width, on the same log scale as the grid.
+    void updateColumns(int width, int fftSize, float binWidth)
+    {
+        if ( width == mappedWidth && fftSize == mappedFFTSize && binWidth == mappedBinWidth )
+            return;
+        mappedWidth = width;
+        mappedFFTSize = fftSize;
+        mappedBinWidth = binWidth;
         
-        p.startNewSubPath(0, y);
+        const int numBins = fftSize / 2;
+        auto getBinPosition = [width, binWidth](float x)
+        {
+            return juce::mapToLog10(x / (float)width, 20.f, 20000.f) / binWidth;
+        };
         
-        // Draw line-to's every pathResolution pixels
-        const int pathResolution = 2;
+        columns.clear();
+        // (no sample rate yet: nothing to draw)
+        if ( binWidth <= 0.f )
+            return;
+        columns.reserve((size_t)juce::jmax(0, width));
         
-        for ( int binNum = 1; binNum < numBins; binNum += pathResolution )
+        for (int x=0; x<width; x++)
         {
-            y = map(renderData[binNum]);
-            
-            //jassert( !std::isnan(y) && !std::isinf(y) );
+            // Every bin from the column's left edge up to (not including) the next column's
+            const auto lowBin = juce::jmax(1, (int)std::ceil(getBinPosition((float)x)));
+            const auto highBin = juce::jmin(numBins, (int)std::ceil(getBinPosition((float)(x + 1))));
             
-            if ( !std::isnan(y) && !std::isinf(y) )
+            Column column;
+            if ( highBin > lowBin )
             {
-                auto binFreq = binNum * binWidth;
-                auto normalizedBinX = juce::mapFromLog10(binFreq, 20.f, 20000.f);
-                int binX = std::floor(normalizedBinX * width);
-                p.lineTo(binX, y);
+                column.firstBin = lowBin;
+                column.numBins = highBin - lowBin;
             }
+            else
+            {
+                // No bin of its own: read between the two either side of the column's centre
+                const auto binPosition = getBinPosition((float)x + 0.5f);
+                column.firstBin = (int)binPosition;
+                column.fraction = binPosition - (float)column.firstBin;
+                
+                // Past Nyquist: nothing more to draw
+                if ( column.firstBin + 1 >= numBins )
+                    break;
+            }
+            columns.push_back(column);
         }
-        
-        pathFIFO.push(p);
-    }
-    
-    int getNumPathsAvailable() const
-    {
-        return pathFIFO.getNumAvailableForReading();
     }
     
-    bool getPath(PathType& path)
-    {
-        return pathFIFO.pull(path);
-    }
-private:
-    Fifo<PathType> pathFIFO;
+    std::vector<Column> columns;
+    int mappedWidth = -1;
+    int mappedFFTSize = -1;
+    float mappedBinWidth = -1.f;
 };
 
 // This class determines the appearance of the rotary slider...
@@ -207,43 +373,121 @@ private:
 // Path generator for response curve
 struct PathGenerator
 {
-    PathGenerator(SingleChannelSampleFifo<_3BandEQAudioProcessor::BlockType>& scsf) :
-    leftChannelFIFO(&scsf)
+    PathGenerator()
     {
         leftChannelFFTDataGenerator.changeOrder(FFTOrder::ORDER_2048);
-        monoBuffer.setSize(1, leftChannelFFTDataGenerator.getFFTSize());
+        // Always enough history for the biggest FFT, so switching up never starts from a half empty window
+        monoBuffer.setSize(1, 1 << ORDER_8192);
+        fftData.reserve((size_t)(2 << ORDER_8192));
     }
     
-    void process(juce::Rectangle<float> fftBounds, double sampleRate);
-
-    juce::Path getPath() { return leftChannelFFTPath; }
+    // Slides numSamples new samples into the analysis window
+    void pushSamples(const float* samples, int numSamples);
+    // Runs an FFT over the newest samples in the window
+    void produceFrame()
+    {
+        leftChannelFFTDataGenerator.produceFFTDataForRendering(monoBuffer.getReadPointer(0), monoBuffer.getNumSamples(), -48.f);
+    }
+    // FFT size changes are built in the background and take effect from a later frame (see FFTDataGenerator)
+    void requestOrder(FFTOrder order) { leftChannelFFTDataGenerator.requestOrder(order); }
+    int getFFTSize() const { return leftChannelFFTDataGenerator.getFFTSize(); }
+    // Starts over from silence (the stream was interrupted)
+    void reset();
+    // Turns the newest FFT data waiting into the trace's y per column of fftBounds (see...
+    // ...AnalyzerColumnGenerator). Returns the number of columns, or 0 if there was no new FFT data.
+    int process(juce::Rectangle<float> fftBounds, double sampleRate, float* columnYs, int maxColumns);
 private:
-    SingleChannelSampleFifo<_3BandEQAudioProcessor::BlockType>* leftChannelFIFO;
-    
     juce::AudioBuffer<float> monoBuffer;
     
     FFTDataGenerator<std::vector<float>> leftChannelFFTDataGenerator;
+    // The FFT frame being drawn. Reserved for the biggest FFT, so pulling frames never allocates.
+    std::vector<float> fftData;
     
-    AnalyzerPathGenerator<juce::Path> pathGenerator;
+    AnalyzerColumnGenerator columnGenerator;
+};
+
+// Ready-to-draw analyzer output, handed from an AnalyzerWorker to the message thread: the y of each...
+// ...channel's trace in every pixel column of the analysis area. Fixed size, so it never allocates.
+struct AnalyzerFrame
+{
+    static constexpr int maxColumns = 2048;
+    std::array<float, maxColumns> left {}, right {};
+    int numColumns = 0;
+};
+
+// Background thread shared by every open editor's analyzer
+struct AnalyzerThread : juce::TimeSliceThread
+{
+    AnalyzerThread() : juce::TimeSliceThread("3BandEQ Analyzer")
+    {
+        startThread();
+    }
     
-    juce::Path leftChannelFFTPath;
+    ~AnalyzerThread() override
+    {
+        stopThread(1000);
+    }
+};
+
+// One editor's whole analysis pipeline, run on the AnalyzerThread: reads the processor's analyzer...
+// ...tap, runs the FFTs, works out the traces, and publishes the newest frame. The message thread just...
+// ...picks frames up and draws them.
+// The tap's ring is only ever read from the worker, so it also does the subscribing.
+struct AnalyzerWorker : juce::TimeSliceClient
+{
+    AnalyzerWorker(_3BandEQAudioProcessor&);
+    ~AnalyzerWorker() override;
+    
+    // Message thread: the analysis area the traces are made for, and whether to analyse at all
+    void setBounds(juce::Rectangle<float> newBounds);
+    void setEnabled(bool shouldBeEnabled) { enabled.store(shouldBeEnabled); }
+    
+    // Message thread: true if a new frame has arrived since the last call (getFrame() has it)
+    bool acquireFrame() { return frames.acquire() != nullptr; }
+    const AnalyzerFrame& getFrame() const { return frames.getReadBuffer(); }
+    
+    int useTimeSlice() override;
+private:
+    _3BandEQAudioProcessor& audioProcessor;
+    
+    // Path generator
+    PathGenerator leftChannelPathGenerator, rightChannelPathGenerator;
+    // Samples pulled from the processor's analyzerRing (left, right)
+    juce::AudioBuffer<float> analyzerInput;
+    // Returns true if it produced a new frame
+    bool pullAnalyzerInput();
+    // Analyzer_Overlap choice index: hop = FFT size / 2, 4 or 8
+    std::atomic<float>* analyzerOverlapParameter = nullptr;
+    // Analyzer_Order choice index: 2048, 4096 or 8192 point FFTs
+    std::atomic<float>* analyzerOrderParameter = nullptr;
+    
+    std::atomic<bool> enabled {true};
+    // Worker side: whether we're subscribed to the tap right now
+    bool subscribed = false;
+    
+    juce::SpinLock boundsLock;
+    juce::Rectangle<float> bounds;
+    
+    TripleBuffer<AnalyzerFrame> frames;
+    
+    juce::SharedResourcePointer<AnalyzerThread> analyzerThread;
 };
 
 // Response Curve struct
 struct ResponseCurve : juce::Component,
-juce::AudioProcessorParameter::Listener,
 juce::Timer
 {
     ResponseCurve(_3BandEQAudioProcessor&);
-    ~ResponseCurve();
-    
-    void parameterValueChanged (int parameterIndex, float newValue) override;
-    
-    void parameterGestureChanged (int parameterIndex, bool gestureIsStarting) override {};
     
     void timerCallback() override;
     
-    void setFFTAnalysisEnabled(bool b) { isFFTAnalysisEnabled = b; }
+    void setFFTAnalysisEnabled(bool b)
+    {
+        isFFTAnalysisEnabled = b;
+        analyzerWorker.setEnabled(b);
+        // Frames only trigger a repaint while it's on, so take the last trace off screen (or put it back) now
+        repaint();
+    }
     
     void paint(juce::Graphics& g) override;
     void resized() override;
@@ -251,23 +495,36 @@ private:
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     _3BandEQAudioProcessor& audioProcessor;
-    // atomic flag to let us know when our parameters have changed...
-    // ...and the GUI needs updating
-    juce::Atomic<bool> parametersChanged {false};
-    // Mono chain
-    MonoChain monoChain;
-    void updateChain();
+    // Band versions the response curve was last drawn for. Compared against the processor's...
+    // ...ChainParameterRegistry to find out which bands have changed and the GUI needs updating
+    ChainParameterRegistry::Versions chainVersions {};
+    // The (possibly oversampled) rate chainCoefficients were designed for
+    double chainSampleRate = 0.0;
+    // The coefficients last designed for the curve
+    ChainCoefficients chainCoefficients;
+    void updateChain(int bandsToUpdate = ALL_BANDS);
     // Response curve grid background
     juce::Image background;
     juce::Rectangle<int> getRenderArea();
     juce::Rectangle<int> getAnalysisArea();
-    // Path generator
-    PathGenerator leftChannelPathGenerator, rightChannelPathGenerator;
+    // Draws a frame's trace straight from its column values, offset by origin
+    static void drawAnalyzerTrace(juce::Graphics& g, const float* columnYs, int numColumns, juce::Point<int> origin);
+    // FFT analysis, done in the background
+    AnalyzerWorker analyzerWorker;
     
     bool isFFTAnalysisEnabled {true};
 };
 
 struct PowerButton : juce::ToggleButton {  };
+// Combo box filled with a choice parameter's options, so it can be attached to it straight away
+struct ChoiceBox : juce::ComboBox
+{
+    ChoiceBox(juce::RangedAudioParameter& rap)
+    {
+        if ( auto* choiceParameter = dynamic_cast<juce::AudioParameterChoice*>(&rap) )
+            addItemList(choiceParameter->choices, 1);
+    }
+};
 struct AnalyzerButton : juce::ToggleButton
 {
     void resized() override
@@ -297,6 +554,22 @@ struct AnalyzerButton : juce::ToggleButton
     juce::Path randomPath;
 };
 
+// Compact processBlock load readout (see ProcessLoadMeter): mean, p99 and max as % of the block's...
+// ...realtime budget, plus overruns. Click to start the statistics over.
+struct LoadMeterOverlay : juce::Component,
+juce::Timer
+{
+    LoadMeterOverlay(_3BandEQAudioProcessor&);
+    
+    void timerCallback() override;
+    void paint(juce::Graphics& g) override;
+    void mouseDown(const juce::MouseEvent&) override;
+private:
+    _3BandEQAudioProcessor& audioProcessor;
+    juce::String text;
+    bool hasOverruns = false;
+};
+
 //==============================================================================
 // Class Declaration
 //==============================================================================
@@ -317,6 +590,7 @@ private:
     _3BandEQAudioProcessor& audioProcessor;
     
     ResponseCurve responseCurve;
+    LoadMeterOverlay loadMeterOverlay;
     
     // Declare our rotary sliders
     RotarySliderWithLabels peakFreqSlider,
@@ -343,6 +617,8 @@ private:
                 highCutBypassButton,
                 peakBypassButton;
     AnalyzerButton analyzerBypassButton;
+    ChoiceBox analyzerOverlapBox,
+              analyzerOrderBox;
     
     // Bypass toggle button attachments for each of our buttons
     using ButtonAttachment = APVTS::ButtonAttachment;
@@ -351,6 +627,10 @@ private:
                      peakBypassButtonAttachment,
                      analyzerBypassButtonAttachment;
     
+    using ComboBoxAttachment = APVTS::ComboBoxAttachment;
+    ComboBoxAttachment analyzerOverlapBoxAttachment,
+                       analyzerOrderBoxAttachment;
+    
     LookAndFeel lookAndFeel;
     
     // Declare a function to return all our rotary sliders and buttons as a vector
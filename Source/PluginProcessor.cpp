@@ -8,6 +8,7 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "RealtimeSafety.h"
 
 //==============================================================================
 _3BandEQAudioProcessor::_3BandEQAudioProcessor()
@@ -22,10 +23,26 @@ _3BandEQAudioProcessor::_3BandEQAudioProcessor()
                        )
 #endif
 {
+    smoothingParameter = APVTS.getRawParameterValue("Smoothing");
+    oversamplingParameter = APVTS.getRawParameterValue("Oversampling");
+    linearPhaseParameter = APVTS.getRawParameterValue("Linear_Phase");
+    APVTS.addParameterListener("Oversampling", this);
+    APVTS.addParameterListener("Linear_Phase", this);
+    
+    // The engine keeps these until it's prepared
+    updateEngineSettings(true);
+    
+    coefficientDesignThread->addTimeSliceClient(this);
 }
 
 _3BandEQAudioProcessor::~_3BandEQAudioProcessor()
 {
+    APVTS.removeParameterListener("Oversampling", this);
+    APVTS.removeParameterListener("Linear_Phase", this);
+    cancelPendingUpdate();
+    
+    // Blocks until the design thread is no longer using us
+    coefficientDesignThread->removeTimeSliceClient(this);
 }
 
 //==============================================================================
@@ -104,12 +121,9 @@ bool _3BandEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout works (mono, stereo, surround, immersive...): every channel gets the same EQ,...
+    // ...so all we need is at least one channel
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -134,16 +148,23 @@ void _3BandEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
     processSpec.numChannels = 1;
     processSpec.sampleRate = sampleRate;
     
-    // Prepare both the left and right chains with our Process Spec
-    leftChain.prepare(processSpec);
-    rightChain.prepare(processSpec);
-
-    // Get the current parameter values and update all filters in the chain
-    updateFilters();
+    // Pick up the phase mode and oversampling factor first, then prepare the engine for however many...
+    // ...channels the current layout has, in the precision the host uses. It designs the filters for...
+    // ...the new (oversampled) rate as part of that.
+    engine.setProcessingMode(getOversamplingStagesWanted(), isLinearPhaseWanted());
+    engine.prepare(sampleRate, samplesPerBlock, getTotalNumOutputChannels(), isUsingDoublePrecision());
+    setLatencySamples(engine.getLatencyInSamples());
+    
+    // Block budgets come from the host's rate (load statistics start over)
+    loadMeter.prepare(sampleRate);
     
-    // prepare our left and right channel buffer FIFOs
-    leftChannelFIFO.prepare(samplesPerBlock);
-    rightChannelFIFO.prepare(samplesPerBlock);
+    // Room for a good few display frames' worth of audio (16k samples), and never less than two blocks.
+    // ...The analyzer thread may be reading it right now, so keep it out while it's reset (or reallocated,...
+    // ...if the blocks got bigger).
+    {
+        const juce::SpinLock::ScopedLockType lock(analyzerRingLock);
+        analyzerRing.prepare(2, juce::jmax(16384, 2 * samplesPerBlock));
+    }
     
     // TEST OSCILLATOR
     osc.initialise([](float x) { return std::sin(x); });
@@ -152,8 +173,25 @@ void _3BandEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
     osc.setFrequency(1000);
 }
 
-void _3BandEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+void _3BandEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    processSamples(buffer);
+}
+
+void _3BandEQAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
 {
+    processSamples(buffer);
+}
+
+template<typename SampleType>
+void _3BandEQAudioProcessor::processSamples (juce::AudioBuffer<SampleType>& buffer)
+{
+    ProcessLoadMeter::ScopedMeasurement loadMeasurement { loadMeter, buffer.getNumSamples() };
+    
+    // Realtime safety builds (EQ_REALTIME_CHECKS) flag any allocation, lock or blocking call from...
+    // ...here on. Offline renders may block, so they aren't checked.
+    RealtimeSafety::ScopedAudioThread audioThread { ! isNonRealtime() };
+    
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -167,29 +205,91 @@ void _3BandEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
     
-    // Get the current parameter values and update all filters in the chain
-    updateFilters();
+    // When bouncing offline nobody is waiting on us, so design any pending changes right here...
+    // ...rather than leaving them to the design thread and missing the start of the render
+    if ( isNonRealtime() )
+        updateEngineSettings(false);
+    
+    // Smoothing control rate in samples (0 = smoothing off)
+    engine.setSmoothingInterval(smoothingControlIntervals[ (size_t)juce::jlimit(0, (int)smoothingControlIntervals.size() - 1,
+                                                                                (int)smoothingParameter->load()) ]);
     
-    // create audio block with size of our buffer
-    juce::dsp::AudioBlock<float> block(buffer);
-   
     // TEST OSCILLATOR
+//    juce::dsp::AudioBlock<float> block(buffer);
 //    buffer.clear();
 //    juce::dsp::ProcessContextReplacing<float> stereoContext(block);
 //    osc.process(stereoContext);
     
-    // extract left and right channels separately from audio block
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
-    // create processing context for left and right channels
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
-    // tell the left and right mono processing chains to use these processing contexts
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
-    // update left and right channel buffer FIFOs
-    leftChannelFIFO.update(buffer);
-    rightChannelFIFO.update(buffer);
+    // run every input channel through the EQ
+    const auto numChannels = juce::jmin(totalNumInputChannels, buffer.getNumChannels());
+    engine.process(buffer.getArrayOfWritePointers(), numChannels, buffer.getNumSamples());
+    
+    // hand the left and right channels to the analyzer, if anyone's looking (if it's fallen behind,...
+    // ...this block is dropped)
+    if ( numAnalyzerSubscribers.load(std::memory_order_acquire) > 0 && buffer.getNumChannels() > 0 )
+    {
+        const SampleType* analyzerChannels[] { buffer.getReadPointer(0),
+                                               buffer.getReadPointer(juce::jmin(1, buffer.getNumChannels() - 1)) };
+        analyzerRing.write(analyzerChannels, buffer.getNumSamples());
+    }
+}
+
+void _3BandEQAudioProcessor::subscribeToAnalyzer()
+{
+    // Nothing is written while there are no subscribers, so anything still in the ring predates the...
+    // ...last unsubscribe: drop it before the audio thread starts writing again
+    if ( numAnalyzerSubscribers.load() == 0 )
+    {
+        const juce::SpinLock::ScopedLockType lock(analyzerRingLock);
+        analyzerRing.skip(analyzerRing.getNumReady());
+    }
+    
+    numAnalyzerSubscribers.fetch_add(1, std::memory_order_release);
+}
+
+void _3BandEQAudioProcessor::unsubscribeFromAnalyzer()
+{
+    jassert(numAnalyzerSubscribers.load() > 0);
+    numAnalyzerSubscribers.fetch_sub(1, std::memory_order_release);
+}
+
+void _3BandEQAudioProcessor::applyProcessingMode()
+{
+    // The engine resets, and redesigns for the new filter rate (the smoother jumps straight there)
+    engine.setProcessingMode(getOversamplingStagesWanted(), isLinearPhaseWanted());
+    setLatencySamples(engine.getLatencyInSamples());
+}
+
+void _3BandEQAudioProcessor::switchProcessingMode()
+{
+    // Not prepared yet: prepareToPlay will pick the setting up
+    if ( getSampleRate() <= 0.0 )
+        return;
+    
+    // Changing mode swaps oversamplers, latency and coefficients all at once, so keep processBlock out of the way
+    suspendProcessing(true);
+    applyProcessingMode();
+    suspendProcessing(false);
+}
+
+void _3BandEQAudioProcessor::parameterChanged(const juce::String&, float)
+{
+    // Not prepared yet (the CLI sets everything up before preparing): prepareToPlay picks it up
+    if ( getSampleRate() <= 0.0 )
+        return;
+    
+    // Offline there may be no message loop at all (the CLI), and the next block has to start in the...
+    // ...new mode anyway, so switch right here. Otherwise this could be any thread (even the audio...
+    // ...thread, for automation): do the switch on the message thread.
+    if ( isNonRealtime() )
+        switchProcessingMode();
+    else
+        triggerAsyncUpdate();
+}
+
+void _3BandEQAudioProcessor::handleAsyncUpdate()
+{
+    switchProcessingMode();
 }
 
 //==============================================================================
@@ -227,112 +327,125 @@ void _3BandEQAudioProcessor::setStateInformation (const void* data, int sizeInBy
     {
         // Feed the values to our APVTS
         APVTS.replaceState(valueTree);
-        // Update filter values to reflect the new state
-        updateFilters();
+        // Have the design thread update the filters to reflect the new state
+        chainParameters.markAllBandsChanged();
     }
 }
 
-// Helper function to return all parameter values from the APVTS as a ChainSettings struct
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& APVTS)
+//=======================================================================================
+// Chain parameter registry
+//=======================================================================================
+
+ChainParameterRegistry::ChainParameterRegistry(juce::AudioProcessorValueTreeState& APVTS)
+{
+    // Resolve every string ID exactly once, and listen for changes so we can bump band versions
+    for (int i=0; i<NUM_CHAIN_PARAMETERS; i++)
+    {
+        auto* parameterID = chainParameterInfo[i].parameterID;
+        
+        values[i] = APVTS.getRawParameterValue(parameterID);
+        parameters[i] = APVTS.getParameter(parameterID);
+        jassert( values[i] != nullptr && parameters[i] != nullptr );
+        
+        parameters[i]->addListener(this);
+    }
+}
+
+ChainParameterRegistry::~ChainParameterRegistry()
+{
+    for (auto* parameter : parameters)
+    {
+        parameter->removeListener(this);
+    }
+}
+
+// Return all parameter values as a ChainSettings struct
+ChainSettings ChainParameterRegistry::getChainSettings() const
 {
     ChainSettings settings;
     
-    // Get all current parameter values from APVTS
-    settings.lowCutFreq     = APVTS.getRawParameterValue("LowCut_Freq")->load();
-    settings.lowCutSlope    = static_cast<Slope>( APVTS.getRawParameterValue("LowCut_Slope")->load() );
+    settings.lowCutFreq     = getValue(PARAM_LOWCUT_FREQ);
+    settings.lowCutSlope    = static_cast<Slope>( getValue(PARAM_LOWCUT_SLOPE) );
     
-    settings.highCutFreq    = APVTS.getRawParameterValue("HighCut_Freq")->load();
-    settings.highCutSlope   = static_cast<Slope>( APVTS.getRawParameterValue("HighCut_Slope")->load() );
+    settings.highCutFreq    = getValue(PARAM_HIGHCUT_FREQ);
+    settings.highCutSlope   = static_cast<Slope>( getValue(PARAM_HIGHCUT_SLOPE) );
     
-    settings.peakFreq       = APVTS.getRawParameterValue("Peak_Freq")->load();
-    settings.peakGain_dB    = APVTS.getRawParameterValue("Peak_Gain")->load();
-    settings.peakQ          = APVTS.getRawParameterValue("Peak_Q")->load();
+    settings.peakFreq       = getValue(PARAM_PEAK_FREQ);
+    settings.peakGain_dB    = getValue(PARAM_PEAK_GAIN);
+    settings.peakQ          = getValue(PARAM_PEAK_Q);
     
-    settings.lowCutBypass   = APVTS.getRawParameterValue("LowCut_Bypass")->load() > 0.5f;
-    settings.highCutBypass  = APVTS.getRawParameterValue("HighCut_Bypass")->load() > 0.5f;
-    settings.peakBypass     = APVTS.getRawParameterValue("Peak_Bypass")->load() > 0.5f;
+    settings.lowCutBypass   = getValue(PARAM_LOWCUT_BYPASS) > 0.5f;
+    settings.highCutBypass  = getValue(PARAM_HIGHCUT_BYPASS) > 0.5f;
+    settings.peakBypass     = getValue(PARAM_PEAK_BYPASS) > 0.5f;
     
     return settings;
 }
 
-//=======================================================================================
-// Filter update functions
-//=======================================================================================
-
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+ChainParameterRegistry::Versions ChainParameterRegistry::getVersions() const
 {
-    // Calculate Peak filter coefficients based on current chain settings.
-    // This is a reference-counted wrapper around an array of float values,
-    //    allocated on the heap (which is "bad"? Look into this. Why is heap bad for real-time audio?)
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-                                                               chainSettings.peakFreq,
-                                                               chainSettings.peakQ,
-                                                               juce::Decibels::decibelsToGain(chainSettings.peakGain_dB));
+    Versions snapshot;
+    for (int band=0; band<NumBands; band++)
+        snapshot[band] = versions[band].load(std::memory_order_acquire);
+    return snapshot;
 }
 
-// Helper function to update filter coefficients
-// (Free function)
-void updateCoefficients(Coefficients &old, const Coefficients &replacement)
+int ChainParameterRegistry::getChangedBands(const Versions& current, const Versions& lastSeen)
 {
-    // Because JUCE DSP's IIR Coefficients are reference-counted on the heap, we need to dereference here
-    *old = *replacement;
+    int changedBands = 0;
+    for (int band=0; band<NumBands; band++)
+    {
+        if ( current[band] != lastSeen[band] )
+            changedBands |= 1 << band;
+    }
+    return changedBands;
 }
 
-// Helper function to update the low cut filter
-void _3BandEQAudioProcessor::updateLowCutFilter(const ChainSettings &chainSettings)
+void ChainParameterRegistry::markAllBandsChanged()
 {
-    // Calculate low cut filter coefficients
-    auto lowCutFilterCoefficients = makeLowCutFilter(chainSettings, getSampleRate());
-    // Get the low cut filter (left and right chains)
-    auto& leftLowCutFilter = leftChain.get<ChainPositions::LowCut>();
-    auto& rightLowCutFilter = rightChain.get<ChainPositions::LowCut>();
-    // Update low cut filter bypass setting
-    leftChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypass);
-    rightChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypass);
-    // Use chain settings to calculate new filter coefficients and apply them to the filter (L and R chains)
-    updateCutFilter(leftLowCutFilter, lowCutFilterCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(rightLowCutFilter, lowCutFilterCoefficients, chainSettings.lowCutSlope);
+    for (auto& version : versions)
+        version.fetch_add(1, std::memory_order_acq_rel);
 }
 
-// Helper function to update the high cut filter
-void _3BandEQAudioProcessor::updateHighCutFilter(const ChainSettings &chainSettings)
+void ChainParameterRegistry::parameterValueChanged(int parameterIndex, float newValue)
 {
-    // Calculate high cut filter coefficients
-    auto highCutFilterCoefficients = makeHighCutFilter(chainSettings, getSampleRate()); 
-    // Get the high cut filter (left and right chains)
-    auto& leftHighCutFilter = leftChain.get<ChainPositions::HighCut>();
-    auto& rightHighCutFilter = rightChain.get<ChainPositions::HighCut>();
-    // Update high cut filter bypass setting
-    leftChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypass);
-    rightChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypass);
-    // Use chain settings to calculate new filter coefficients and apply them to the filter (L and R chains)
-    updateCutFilter(leftHighCutFilter, highCutFilterCoefficients, chainSettings.highCutSlope);
-    updateCutFilter(rightHighCutFilter, highCutFilterCoefficients, chainSettings.highCutSlope);
+    // Find which of our parameters this is (ten int compares; no maps, no allocation)
+    for (int i=0; i<NUM_CHAIN_PARAMETERS; i++)
+    {
+        if ( parameters[i]->getParameterIndex() == parameterIndex )
+        {
+            versions[chainParameterInfo[i].band].fetch_add(1, std::memory_order_acq_rel);
+            return;
+        }
+    }
 }
 
-// Helper function to update the peak filter
-void _3BandEQAudioProcessor::updatePeakFilter(const ChainSettings &chainSettings)
+//=======================================================================================
+// Handing settings to the engine
+//=======================================================================================
+
+void _3BandEQAudioProcessor::updateEngineSettings(bool allBands)
 {
-    // Calculate Peak filter coefficients based on current chain settings.
-    auto updatedPeakCoefficients = makePeakFilter(chainSettings, getSampleRate());
-    // Update peak filter bypass setting
-    leftChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypass);
-    rightChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypass);
-    // Apply those coefficients to the peak filter (left chain and right chain)
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, updatedPeakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, updatedPeakCoefficients);
+    // Only one thread may hand settings over at a time
+    const juce::ScopedLock designLock(coefficientDesignLock);
+    
+    // Take the versions before reading any values, so a change arriving mid-design...
+    // ...still shows up as a change on the next pass
+    auto versions = chainParameters.getVersions();
+    auto bandsToDesign = allBands ? (int)ALL_BANDS
+                                  : ChainParameterRegistry::getChangedBands(versions, designedVersions);
+    if ( bandsToDesign == 0 )
+        return;
+    
+    designedVersions = versions;
+    engine.setSettings(chainParameters.getChainSettings(), bandsToDesign);
 }
 
-// Helper function to update all the filters
-void _3BandEQAudioProcessor::updateFilters()
+int _3BandEQAudioProcessor::useTimeSlice()
 {
-    // Get the current chain settings (parameter values)
-    auto settings = getChainSettings(APVTS);
+    // Cheap when nothing moved: a handful of atomic loads
+    updateEngineSettings(false);
     
-    // Update the low-cut, peaking, and high-cut filters
-    updateLowCutFilter(settings);
-    updatePeakFilter(settings);
-    updateHighCutFilter(settings);
+    return coefficientDesignIntervalMs;
 }
 
 //=======================================================================================
@@ -414,6 +527,36 @@ juce::AudioProcessorValueTreeState::ParameterLayout _3BandEQAudioProcessor::crea
                                                           "Analyzer_Bypass",
                                                           true));
     
+    // Spectrum Analyzer FFT size: finer low end resolution at 8192, cheapest at 2048
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Analyzer_Order",
+                                                            "Analyzer_Order",
+                                                            juce::StringArray {"2048", "4096", "8192"},
+                                                            0) );
+    
+    // Spectrum Analyzer FFT overlap: a new frame every 1/2, 1/4 or 1/8 of the FFT size (capped at the...
+    // ...display's frame rate)
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Analyzer_Overlap",
+                                                            "Analyzer_Overlap",
+                                                            juce::StringArray {"50%", "75%", "87.5%"},
+                                                            1) );
+    
+    // Coefficient smoothing control rate (see smoothingControlIntervals)
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Smoothing",
+                                                            "Smoothing",
+                                                            juce::StringArray {"Off", "16 samples", "32 samples", "64 samples"},
+                                                            0) );
+    
+    // Oversampling factor for the filters (index = number of 2x stages, see OversampledChain)
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Oversampling",
+                                                            "Oversampling",
+                                                            juce::StringArray {"Off", "2x", "4x"},
+                                                            0) );
+    
+    // Linear phase mode: the same bands as a linear phase FIR (adds a lot of latency, see LinearPhaseConvolver)
+    layout.add(std::make_unique<juce::AudioParameterBool>("Linear_Phase",
+                                                          "Linear_Phase",
+                                                          false));
+    
     return layout;
 }
 
@@ -12,261 +12,103 @@
 
 #include <array>
 
-enum Channel
+#include "DSP/EQEngine.h"
+#include "DSP/ChainDesign.h"
+#include "DSP/SampleRing.h"
+#include "DSP/ProcessLoadMeter.h"
+
+// Every parameter that feeds the filter chain, in a fixed order
+enum ChainParameterIndex
 {
-    LEFT,   // 0
-    RIGHT   // 1
+    PARAM_LOWCUT_FREQ,
+    PARAM_LOWCUT_SLOPE,
+    PARAM_LOWCUT_BYPASS,
+    PARAM_PEAK_FREQ,
+    PARAM_PEAK_GAIN,
+    PARAM_PEAK_Q,
+    PARAM_PEAK_BYPASS,
+    PARAM_HIGHCUT_FREQ,
+    PARAM_HIGHCUT_SLOPE,
+    PARAM_HIGHCUT_BYPASS,
+    NUM_CHAIN_PARAMETERS
 };
 
-// FIFO queue for the SingleChannelSampleFifo class
-template<typename T>
-struct Fifo
+// Compile-time table of each chain parameter's APVTS ID and the band it belongs to
+struct ChainParameterInfo
 {
-    void prepare(int numChannels, int numSamples)
-    {
-        static_assert(std::is_same_v<T, juce::AudioBuffer<float>>,
-                      "prepare(numChannels, numSamples) should only be used when the FIFO is holding a juce::AudioBuffer<float>.");
-        
-        for ( auto& buffer : buffers )
-        {
-            buffer.setSize(numChannels,
-                           numSamples,
-                           false,           // clear everything?
-                           true,            // including the extra space?
-                           true);           // avoid reallocating?
-            buffer.clear();
-        }
-    }
-    
-    void prepare(size_t numElements)
-    {
-        static_assert(std::is_same_v<T, std::vector<float>>,
-                      "prepare(numElements) should only be used when the FIFO is holding a std::vector<float>.");
-        
-        for ( auto& buffer : buffers )
-        {
-            buffer.clear();
-            buffer.resize(numElements, 0);
-        }
+    const char* parameterID;
+    ChainPositions band;
+};
 
-    }
+inline constexpr std::array<ChainParameterInfo, NUM_CHAIN_PARAMETERS> chainParameterInfo
+{{
+    { "LowCut_Freq",    ChainPositions::LowCut  },
+    { "LowCut_Slope",   ChainPositions::LowCut  },
+    { "LowCut_Bypass",  ChainPositions::LowCut  },
+    { "Peak_Freq",      ChainPositions::Peak    },
+    { "Peak_Gain",      ChainPositions::Peak    },
+    { "Peak_Q",         ChainPositions::Peak    },
+    { "Peak_Bypass",    ChainPositions::Peak    },
+    { "HighCut_Freq",   ChainPositions::HighCut },
+    { "HighCut_Slope",  ChainPositions::HighCut },
+    { "HighCut_Bypass", ChainPositions::HighCut }
+}};
+
+// Typed, cached access to the chain parameters.
+// The std::atomic<float>* for each parameter is looked up by string ID once, at construction,
+// and each band keeps a version number that is bumped whenever one of its parameters changes.
+// Comparing versions lets callers skip all work for bands that haven't moved.
+struct ChainParameterRegistry : juce::AudioProcessorParameter::Listener
+{
+    static constexpr int NumBands = 3;
+    using Versions = std::array<uint32_t, NumBands>;
     
-    bool push(const T& t)
-    {
-        auto write = fifo.write(1);
-        if ( write.blockSize1 > 0 )
-        {
-            buffers[write.startIndex1] = t;
-            return true;
-        }
-        
-        return false;
-    }
+    ChainParameterRegistry(juce::AudioProcessorValueTreeState& APVTS);
+    ~ChainParameterRegistry() override;
     
-    bool pull(T& t)
-    {
-        auto read = fifo.read(1);
-        if ( read.blockSize1 > 0 )
-        {
-            t = buffers[read.startIndex1];
-            return true;
-        }
-        
-        return false;
-    }
+    // Returns all current parameter values as a ChainSettings struct. No string lookups, no locks.
+    ChainSettings getChainSettings() const;
+    float getValue(ChainParameterIndex index) const { return values[index]->load(); }
     
-    int getNumAvailableForReading() const
-    {
-        return fifo.getNumReady();
-    }
+    Versions getVersions() const;
+    // Returns a BandMask of the bands whose version differs between the two snapshots
+    static int getChangedBands(const Versions& current, const Versions& lastSeen);
+    int getChangedBands(const Versions& lastSeen) const { return getChangedBands(getVersions(), lastSeen); }
+    
+    // Forces every band to look changed, e.g. after restoring state
+    void markAllBandsChanged();
+    
+    // May be called on any thread (including the audio thread): just bumps a version
+    void parameterValueChanged (int parameterIndex, float newValue) override;
+    void parameterGestureChanged (int parameterIndex, bool gestureIsStarting) override {}
 private:
-    static constexpr int Capacity = 30;
-    std::array<T, Capacity> buffers;
-    juce::AbstractFifo fifo {Capacity};
+    std::array<std::atomic<float>*, NUM_CHAIN_PARAMETERS> values {};
+    std::array<juce::RangedAudioParameter*, NUM_CHAIN_PARAMETERS> parameters {};
+    std::array<std::atomic<uint32_t>, NumBands> versions {};
 };
 
-// Converts some-number-of-samples from a host buffer into a FIFO queue of fixed-size blocks
-template<typename BlockType>
-struct SingleChannelSampleFifo
+// One low-priority background thread, shared by every instance of the plugin, that redesigns...
+// ...filter coefficients whenever an instance's parameters have changed.
+struct CoefficientDesignThread : juce::TimeSliceThread
 {
-    SingleChannelSampleFifo(Channel channel) : channelToUse(channel)
-    {
-        prepared.set(false);
-    }
-    
-    void update(const BlockType& buffer)
+    CoefficientDesignThread() : juce::TimeSliceThread("3BandEQ Coefficient Designer")
     {
-        jassert(prepared.get());
-        jassert(buffer.getNumChannels() > channelToUse);
-        auto* channelPtr = buffer.getReadPointer(channelToUse);
-        
-        for (int i = 0; i < buffer.getNumSamples(); i++)
-        {
-            pushNextSampleIntoFifo(channelPtr[i]);
-        }
+        startThread();
     }
     
-    void prepare(int bufferSize)
-    {
-        prepared.set(false);
-        size.set(bufferSize);
-        
-        bufferToFill.setSize(1,             // channel
-                             bufferSize,    // number of samples
-                             false,         // keep existing content?
-                             true,          // clear extra space?
-                             true);         // avoid reallocating?
-        audioBufferFifo.prepare(1, bufferSize);
-        fifoIndex = 0;
-        prepared.set(true);
-    }
-    //===========================================================================
-    int getNumCompleteBuffersAvailable() const { return audioBufferFifo.getNumAvailableForReading(); }
-    bool isPrepared() const { return prepared.get(); }
-    int getSize() const { return size.get(); }
-    //===========================================================================
-    bool getAudioBuffer(BlockType& buffer) { return audioBufferFifo.pull(buffer); }
-private:
-    Channel channelToUse;
-    int fifoIndex = 0;
-    Fifo<BlockType> audioBufferFifo;
-    BlockType bufferToFill;
-    juce::Atomic<bool> prepared = false;
-    juce::Atomic<int> size = 0;
-    
-    void pushNextSampleIntoFifo(float sample)
+    ~CoefficientDesignThread() override
     {
-        if (fifoIndex == bufferToFill.getNumSamples())
-        {
-            auto ok = audioBufferFifo.push(bufferToFill);
-            
-            juce::ignoreUnused(ok);
-            
-            fifoIndex = 0;
-        }
-        
-        bufferToFill.setSample(0, fifoIndex, sample);
-        fifoIndex++;
+        stopThread(1000);
     }
 };
 
-// Filter slope enum
-enum Slope
-{
-    SLOPE_12,
-    SLOPE_24,
-    SLOPE_36,
-    SLOPE_48
-};
-
-// Set up a struct to contain all parameter settings in the chain
-struct ChainSettings
-{
-    float lowCutFreq {0}, highCutFreq {0};
-    Slope lowCutSlope {Slope::SLOPE_12}, highCutSlope {Slope::SLOPE_12};
-    float peakFreq {0}, peakGain_dB {0}, peakQ {1.f};
-    
-    bool lowCutBypass {false}, highCutBypass {false}, peakBypass {false};
-};
-
-// Helper function to return all parameter values from the APVTS as a ChainSettings struct
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& APVTS);
-
-// Shorthand for basic IIR filter. 12dB/oct by default.
-using Filter = juce::dsp::IIR::Filter<float>;
-// Sub-processing chain for our Low/High Cut filters, consisting of FOUR 12dB/oct filters.
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
-// Our single-channel processing chain: (Low)Cut Filter, Peaking Filter, (High)Cut Filter.
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
-
-// Define enum to simplify accessing each link in the processing chain
-enum ChainPositions{
-    LowCut,     //0
-    Peak,       //1
-    HighCut     //2
-};
-
-//
-using Coefficients = Filter::CoefficientsPtr;
-void updateCoefficients(Coefficients& old, const Coefficients& replacement);
-
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
-
-// Helper function to update a filter component (one of the four 12dB/oct "sub"-filters that...
-// ...make up the low- and high-cut filters in our chain).
-template<int FilterComponentIndex, typename ChainType, typename CoefficientType>
-void updateFilterComponent(ChainType& chain, CoefficientType& lowCutFilterCoefficients)
-{
-    // Pass the current filter-chain parameter settings to the filters as coefficients
-    updateCoefficients( chain.template get<FilterComponentIndex>().coefficients,
-                        lowCutFilterCoefficients[FilterComponentIndex] );
-    // Stop bypassing filter components as required
-    chain.template setBypassed<FilterComponentIndex>(false);
-}
-
-// Helper function to update a cut filter
-template<typename ChainType, typename CoefficientType>
-void updateCutFilter(ChainType& lowCutFilter,
-                     const CoefficientType& lowCutFilterCoefficients,
-                     const Slope& lowCutFilterSlope)
-{
-    // Bypass each 12dB/oct filter component in the low cut filter...
-    lowCutFilter.template setBypassed<0>(true);
-    lowCutFilter.template setBypassed<1>(true);
-    lowCutFilter.template setBypassed<2>(true);
-    lowCutFilter.template setBypassed<3>(true);
-
-    // ...Then update/re-enable them as demanded by the current chain settings
-    switch( lowCutFilterSlope )
-    {
-        // If chain settings specify 8th order (48 dB/oct) slope,
-        //   turn on all four 12 dB/oct filters. (indeces 0,1,2,3)
-        // If chain settings specify 6th order (36 dB/oct) slope,
-        //   turn on three of the four 12 dB/oct filters. (indeces 0,1,2)
-        // and so on...
-        case SLOPE_48:
-        {
-            updateFilterComponent<3>(lowCutFilter, lowCutFilterCoefficients);
-        }
-        case SLOPE_36:
-        {
-            updateFilterComponent<2>(lowCutFilter, lowCutFilterCoefficients);
-        }
-        case SLOPE_24:
-        {
-            updateFilterComponent<1>(lowCutFilter, lowCutFilterCoefficients);
-        }
-        case SLOPE_12:
-        {
-            updateFilterComponent<0>(lowCutFilter, lowCutFilterCoefficients);
-        }
-    }
-}
-
-inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-    // Calculate filter order (2, 4, 6, or 8) from filter slope parameters (0, 1, 2, or 3)
-    auto lowCutFilterOrder = 2 * (chainSettings.lowCutSlope + 1);
-    // Calculate and return the low cut filter coefficients
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq,
-                                                                                       sampleRate,
-                                                                                       lowCutFilterOrder);
-}
-
-inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-    // Calculate filter order (2, 4, 6, or 8) from filter slope parameters (0, 1, 2, or 3)
-    auto highCutFilterOrder = 2 * (chainSettings.highCutSlope + 1);
-    // Calculate and return the high cut filter coefficients
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq,
-                                                                                      sampleRate,
-                                                                                      highCutFilterOrder);
-}
-
 //==============================================================================
 /**
 */
-class _3BandEQAudioProcessor  : public juce::AudioProcessor
+class _3BandEQAudioProcessor  : public juce::AudioProcessor,
+                                juce::TimeSliceClient,
+                                juce::AudioProcessorValueTreeState::Listener,
+                                juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -282,6 +124,10 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    
+    // 64-bit hosts can hand us doubles directly instead of converting to float and back
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -309,24 +155,73 @@ public:
     //==============================================================================
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     juce::AudioProcessorValueTreeState APVTS {*this, nullptr, "Parameters", createParameterLayout()};
-
-    using BlockType = juce::AudioBuffer<float>;
-    SingleChannelSampleFifo<BlockType> leftChannelFIFO { Channel::LEFT };
-    SingleChannelSampleFifo<BlockType> rightChannelFIFO { Channel::RIGHT };
+    ChainParameterRegistry chainParameters {APVTS};
+    
+    //==============================================================================
+    // Called on the shared CoefficientDesignThread
+    int useTimeSlice() override;
+    
+    // The rate the filter coefficients are designed for: the host's sample rate times the oversampling...
+    // ...factor (in linear phase mode, the rate the FIR's magnitude response is taken from)
+    double getFilterSampleRate() const { return engine.getFilterSampleRate(); }
+    
+    // How much of each block's realtime budget processBlock has used since prepareToPlay (or the last...
+    // ...reset). Any thread.
+    ProcessLoadMeter::Statistics getLoadStatistics() const { return loadMeter.getStatistics(); }
+    void resetLoadStatistics() { loadMeter.reset(); }
+
+    // Post-EQ audio for the analyzer: channel 0 is left, 1 is right (a mono bus feeds both). Only...
+    // ...written while somebody is subscribed; with no subscribers processBlock does no capture at all.
+    // Subscribers read the ring from one thread, one at a time (it's single consumer), and only while...
+    // ...holding analyzerRingLock (try-lock it, and come back next time if it's taken): prepareToPlay...
+    // ...holds it while it resets or reallocates the ring.
+    MultiChannelSampleRing analyzerRing;
+    juce::SpinLock analyzerRingLock;
+    // Subscribing throws away whatever was left in the ring, so reading starts from the next block
+    void subscribeToAnalyzer();
+    void unsubscribeFromAnalyzer();
     
 private:
-    // Declare two of these mono chains. One for left channel, one for right channel.
-    MonoChain leftChain, rightChain;
+    // The EQ itself: filters, oversampling, linear phase and smoothing over every channel of the...
+    // ...main bus. This class just feeds it parameter values and the host's buffers.
+    EQEngine engine;
+    
+    // Times every processBlock call
+    ProcessLoadMeter loadMeter;
+    
+    std::atomic<int> numAnalyzerSubscribers {0};
+    
+    // Shared by both processBlock overloads
+    template<typename SampleType>
+    void processSamples(juce::AudioBuffer<SampleType>& buffer);
+    
+    std::atomic<float>* oversamplingParameter = nullptr;
+    std::atomic<float>* linearPhaseParameter = nullptr;
+    std::atomic<float>* smoothingParameter = nullptr;
+    
+    int getOversamplingStagesWanted() const { return (int)oversamplingParameter->load(); }
+    bool isLinearPhaseWanted() const { return linearPhaseParameter->load() > 0.5f; }
+    
+    // Switches the engine to the phase mode and oversampling factor the parameters ask for, and...
+    // ...reports the new latency. Must not run concurrently with processBlock.
+    void applyProcessingMode();
     
-    void updatePeakFilter(const ChainSettings& ChainSettings);
+    // applyProcessingMode with processBlock suspended (once there's a sample rate to switch at)
+    void switchProcessingMode();
     
-    // Helper functions to update low- and high- cut filters
-    void updateLowCutFilter(const ChainSettings& chainSettings);
-    void updateHighCutFilter(const ChainSettings& chainSettings);
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void handleAsyncUpdate() override;
     
+    // Hands the engine the current settings, to redesign the bands whose parameters changed since...
+    // ...the last call (or all of them)
+    void updateEngineSettings(bool allBands);
     
-    // Helper function to update all filters in the chain
-    void updateFilters();
+    // Serialises updateEngineSettings (design thread vs. prepareToPlay), and guards designedVersions
+    juce::CriticalSection coefficientDesignLock;
+    ChainParameterRegistry::Versions designedVersions {};
+    // How often (ms) the design thread checks this instance for parameter changes
+    static constexpr int coefficientDesignIntervalMs = 5;
+    juce::SharedResourcePointer<CoefficientDesignThread> coefficientDesignThread;
     
     // TEST OSCILLATOR
     juce::dsp::Oscillator<float> osc;
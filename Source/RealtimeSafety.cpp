@@ -0,0 +1,161 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.cpp
+
+  ==============================================================================
+*/
+
+#include "RealtimeSafety.h"
+
+#if EQ_REALTIME_CHECKS
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <set>
+
+namespace
+{
+    // Plain, constant-initialised ints: reading them never allocates, even from inside malloc
+    thread_local int audioThreadDepth = 0;
+    thread_local int suspendDepth = 0;
+    
+    std::atomic<int> numViolations {0};
+    std::atomic<int> failureMode {RealtimeSafety::LOG_VIOLATIONS};
+    
+    bool shouldCheck()
+    {
+        return audioThreadDepth > 0 && suspendDepth == 0;
+    }
+    
+    // Lets the checker itself allocate, lock and write while it reports
+    struct ScopedSuspension
+    {
+        ScopedSuspension()  { ++suspendDepth; }
+        ~ScopedSuspension() { --suspendDepth; }
+    };
+    
+    const char* getViolationName(RealtimeSafety::Violation violation)
+    {
+        switch (violation)
+        {
+            case RealtimeSafety::HEAP_ALLOCATION:   return "heap allocation";
+            case RealtimeSafety::HEAP_FREE:         return "heap free";
+            case RealtimeSafety::MUTEX_LOCK:        return "mutex lock";
+            case RealtimeSafety::BLOCKING_CALL:     return "blocking call";
+        }
+        return "violation";
+    }
+}
+
+RealtimeSafety::ScopedAudioThread::ScopedAudioThread(bool isRealtime) : active(isRealtime)
+{
+    if ( active )
+        ++audioThreadDepth;
+}
+
+RealtimeSafety::ScopedAudioThread::~ScopedAudioThread()
+{
+    if ( active )
+        --audioThreadDepth;
+}
+
+void RealtimeSafety::setFailureMode(FailureMode mode)
+{
+    failureMode.store(mode);
+}
+
+int RealtimeSafety::getNumViolations()
+{
+    return numViolations.load();
+}
+
+void RealtimeSafety::resetViolationCount()
+{
+    numViolations.store(0);
+}
+
+void RealtimeSafety::reportViolation(Violation violation, const char* function)
+{
+    ScopedSuspension suspension;
+    numViolations++;
+    
+    const auto stack = juce::SystemStats::getStackBacktrace();
+    
+    // The same call usually happens on every block: print each distinct stack once
+    static std::mutex reportLock;
+    static std::set<juce::String> reportedStacks;
+    {
+        const std::lock_guard<std::mutex> guard(reportLock);
+        if ( reportedStacks.insert(stack).second )
+            std::fprintf(stderr, "\nRealtime safety violation: %s (%s) on the audio thread\n%s\n",
+                         getViolationName(violation), function, stack.toRawUTF8());
+    }
+    
+    if ( failureMode.load() == TRAP_ON_VIOLATION )
+        std::abort();
+}
+
+// Entry points for the C interposers
+extern "C" int eqRealtimeShouldCheck(void)
+{
+    return shouldCheck() ? 1 : 0;
+}
+
+extern "C" void eqRealtimeReport(int violation, const char* function)
+{
+    RealtimeSafety::reportViolation((RealtimeSafety::Violation)violation, function);
+}
+
+extern "C" void eqRealtimeSuspend(int suspend)
+{
+    suspendDepth += suspend ? 1 : -1;
+}
+
+#if ! (defined (__linux__) && defined (__GLIBC__))
+// No C library interposition here: catch C++ allocations by replacing the global operator new/delete
+void* operator new(std::size_t size)
+{
+    if ( shouldCheck() )
+        RealtimeSafety::reportViolation(RealtimeSafety::HEAP_ALLOCATION, "operator new");
+    
+    if ( auto* memory = std::malloc(size > 0 ? size : 1) )
+        return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+    if ( memory != nullptr && shouldCheck() )
+        RealtimeSafety::reportViolation(RealtimeSafety::HEAP_FREE, "operator delete");
+    
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    operator delete(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    operator delete(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+    operator delete(memory);
+}
+#endif
+
+#endif
@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.h
+
+    Debug/profiling aid: catches heap, lock and blocking calls made while
+    processBlock runs.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+// Build with EQ_REALTIME_CHECKS=1 (the command line tool's RTCheck configuration) to switch the...
+// ...checks on. Off (the default), everything here compiles away to nothing.
+#ifndef EQ_REALTIME_CHECKS
+ #define EQ_REALTIME_CHECKS 0
+#endif
+
+// While a ScopedAudioThread is alive, its thread counts as the audio thread, and any of these made...
+// ...on it is a violation:
+//   - heap allocation or free (malloc and friends, which operator new/delete and juce::HeapBlock use)
+//   - locking a mutex or read/write lock (std::mutex, std::shared_mutex, juce::CriticalSection...).
+//     Try-locks don't block, so they're fine.
+//   - blocking calls: sleeping, semaphore and condition variable waits (juce::WaitableEvent,...
+//     ...std::condition_variable), joining a thread, and file/pipe/socket I/O.
+// Each violation is counted and logged to stderr with a stack trace (once per distinct stack). In...
+// ...TRAP_ON_VIOLATION mode the process aborts right after logging, so a debugger stops on it.
+//
+// The C library calls are caught by interposing them (RealtimeSafetyInterposers.c), which only the...
+// ...Linux (glibc) build does; elsewhere only C++ new and delete are caught. Interposing malloc...
+// ...affects the whole process, so this is for the command line tool, not a plugin inside a host.
+struct RealtimeSafety
+{
+    enum Violation
+    {
+        HEAP_ALLOCATION,
+        HEAP_FREE,
+        MUTEX_LOCK,
+        BLOCKING_CALL
+    };
+    
+    enum FailureMode
+    {
+        LOG_VIOLATIONS,
+        TRAP_ON_VIOLATION
+    };
+    
+   #if EQ_REALTIME_CHECKS
+    // Marks the calling thread as the audio thread until destroyed (if isRealtime; offline...
+    // ...rendering is allowed to block). Nests.
+    struct ScopedAudioThread
+    {
+        explicit ScopedAudioThread(bool isRealtime = true);
+        ~ScopedAudioThread();
+    private:
+        bool active;
+    };
+    
+    static constexpr bool isEnabled() { return true; }
+    static void setFailureMode(FailureMode mode);
+    static int getNumViolations();
+    static void resetViolationCount();
+    
+    // Called by the interposed functions when one of them runs on a marked thread
+    static void reportViolation(Violation violation, const char* function);
+   #else
+    struct ScopedAudioThread
+    {
+        explicit ScopedAudioThread(bool = true) {}
+    };
+    
+    static constexpr bool isEnabled() { return false; }
+    static void setFailureMode(FailureMode) {}
+    static int getNumViolations() { return 0; }
+    static void resetViolationCount() {}
+   #endif
+};
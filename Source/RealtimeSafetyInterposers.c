@@ -0,0 +1,154 @@
+/*
+  ==============================================================================
+
+    RealtimeSafetyInterposers.c
+
+    Linux (glibc) replacements for the C library calls RealtimeSafety watches.
+    Each one reports if it's called on a marked audio thread, then does the
+    real work. Written in C so the definitions match the C library's own
+    declarations exactly.
+
+  ==============================================================================
+*/
+
+#ifndef EQ_REALTIME_CHECKS
+ #define EQ_REALTIME_CHECKS 0
+#endif
+
+#if EQ_REALTIME_CHECKS && defined (__linux__)
+
+#ifndef _GNU_SOURCE
+ #define _GNU_SOURCE
+#endif
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdlib.h>
+#include <sys/select.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined (__GLIBC__)
+
+// Same order as RealtimeSafety::Violation
+enum { HEAP_ALLOCATION, HEAP_FREE, MUTEX_LOCK, BLOCKING_CALL };
+
+// In RealtimeSafety.cpp
+int eqRealtimeShouldCheck(void);
+void eqRealtimeReport(int violation, const char* function);
+void eqRealtimeSuspend(int suspend);
+
+// glibc's own allocator entry points, so the malloc family can be wrapped without dlsym (which allocates)
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* memory, size_t size);
+extern void __libc_free(void* memory);
+extern void* __libc_memalign(size_t alignment, size_t size);
+
+#define CHECK(violation, function) \
+    if ( eqRealtimeShouldCheck() ) \
+        eqRealtimeReport(violation, function)
+
+// The next definition of a function (the C library's), looked up once with the checks suspended
+static void* findNext(void** cached, const char* name)
+{
+    if ( *cached == NULL )
+    {
+        eqRealtimeSuspend(1);
+        *cached = dlsym(RTLD_NEXT, name);
+        eqRealtimeSuspend(0);
+    }
+    return *cached;
+}
+
+//==============================================================================
+void* malloc(size_t size)
+{
+    CHECK(HEAP_ALLOCATION, "malloc");
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    CHECK(HEAP_ALLOCATION, "calloc");
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* memory, size_t size)
+{
+    CHECK(HEAP_ALLOCATION, "realloc");
+    return __libc_realloc(memory, size);
+}
+
+void free(void* memory)
+{
+    if ( memory != NULL )
+        CHECK(HEAP_FREE, "free");
+    __libc_free(memory);
+}
+
+void* memalign(size_t alignment, size_t size)
+{
+    CHECK(HEAP_ALLOCATION, "memalign");
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size)
+{
+    CHECK(HEAP_ALLOCATION, "aligned_alloc");
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** result, size_t alignment, size_t size)
+{
+    CHECK(HEAP_ALLOCATION, "posix_memalign");
+    
+    if ( alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0 )
+        return EINVAL;
+    
+    *result = __libc_memalign(alignment, size);
+    return *result != NULL ? 0 : ENOMEM;
+}
+
+//==============================================================================
+// Wraps a call that can block: report it as the given violation, then forward to the C library's version
+#define CHECKED_CALL_WRAPPER(violation, returnType, name, parameters, arguments) \
+    returnType name parameters \
+    { \
+        static void* next = NULL; \
+        CHECK(violation, #name); \
+        return ((returnType (*) parameters)findNext(&next, #name)) arguments; \
+    }
+
+#define MUTEX_LOCK_WRAPPER(returnType, name, parameters, arguments) \
+    CHECKED_CALL_WRAPPER(MUTEX_LOCK, returnType, name, parameters, arguments)
+
+#define BLOCKING_CALL_WRAPPER(returnType, name, parameters, arguments) \
+    CHECKED_CALL_WRAPPER(BLOCKING_CALL, returnType, name, parameters, arguments)
+
+MUTEX_LOCK_WRAPPER(int, pthread_mutex_lock,    (pthread_mutex_t* mutex),   (mutex))
+MUTEX_LOCK_WRAPPER(int, pthread_rwlock_rdlock, (pthread_rwlock_t* lock),   (lock))
+MUTEX_LOCK_WRAPPER(int, pthread_rwlock_wrlock, (pthread_rwlock_t* lock),   (lock))
+
+BLOCKING_CALL_WRAPPER(ssize_t, read,         (int fd, void* buffer, size_t count),                      (fd, buffer, count))
+BLOCKING_CALL_WRAPPER(ssize_t, write,        (int fd, const void* buffer, size_t count),                (fd, buffer, count))
+BLOCKING_CALL_WRAPPER(int,     poll,         (struct pollfd* fds, nfds_t numFds, int timeout),          (fds, numFds, timeout))
+BLOCKING_CALL_WRAPPER(int,     select,       (int numFds, fd_set* readFds, fd_set* writeFds,
+                                              fd_set* exceptFds, struct timeval* timeout),              (numFds, readFds, writeFds, exceptFds, timeout))
+BLOCKING_CALL_WRAPPER(int,     nanosleep,    (const struct timespec* duration, struct timespec* remaining), (duration, remaining))
+BLOCKING_CALL_WRAPPER(int,     usleep,       (useconds_t microseconds),                                 (microseconds))
+BLOCKING_CALL_WRAPPER(int,     sem_wait,     (sem_t* semaphore),                                        (semaphore))
+BLOCKING_CALL_WRAPPER(int,     sem_timedwait, (sem_t* semaphore, const struct timespec* deadline),      (semaphore, deadline))
+BLOCKING_CALL_WRAPPER(int,     pthread_join, (pthread_t thread, void** result),                         (thread, result))
+
+// Condition variable waits (juce::WaitableEvent, std::condition_variable). The mutex they need is...
+// ...usually locked just before, but not always on this thread, and the wait is what actually blocks.
+BLOCKING_CALL_WRAPPER(int,     pthread_cond_wait,      (pthread_cond_t* condition, pthread_mutex_t* mutex),  (condition, mutex))
+BLOCKING_CALL_WRAPPER(int,     pthread_cond_timedwait, (pthread_cond_t* condition, pthread_mutex_t* mutex,
+                                                        const struct timespec* deadline),                   (condition, mutex, deadline))
+
+#endif
+#endif
@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    Baselines.cpp
+
+  ==============================================================================
+*/
+
+#include "Baselines.h"
+
+//=======================================================================================
+// MonoChain coefficients
+//=======================================================================================
+
+// Copies a designed section into a filter's existing coefficient storage, without reallocating it
+static void copySectionCoefficients(Coefficients& coefficients, const SectionCoefficients& section)
+{
+    jassert( coefficients->coefficients.size() == (int)section.size() );
+    auto* rawCoefficients = coefficients->getRawCoefficients();
+    for (size_t i=0; i<section.size(); i++)
+        rawCoefficients[i] = (float)section[i];
+}
+
+// Helper function to apply a designed cut filter component (12dB/oct "sub"-filter), in place
+template<int FilterComponentIndex, typename CutFilterType>
+static void applyCutFilterComponent(CutFilterType& cutFilter,
+                                    const CutFilterCoefficients& sections,
+                                    Slope slope)
+{
+    // Component N is only needed for slopes steeper than N * 12 dB/oct
+    const bool isNeeded = FilterComponentIndex <= slope;
+    
+    if ( isNeeded )
+        copySectionCoefficients(cutFilter.template get<FilterComponentIndex>().coefficients,
+                                sections[FilterComponentIndex]);
+    
+    cutFilter.template setBypassed<FilterComponentIndex>( !isNeeded );
+}
+
+template<typename CutFilterType>
+static void applyCutFilter(CutFilterType& cutFilter,
+                           const CutFilterCoefficients& sections,
+                           Slope slope)
+{
+    applyCutFilterComponent<0>(cutFilter, sections, slope);
+    applyCutFilterComponent<1>(cutFilter, sections, slope);
+    applyCutFilterComponent<2>(cutFilter, sections, slope);
+    applyCutFilterComponent<3>(cutFilter, sections, slope);
+}
+
+// A 2nd order section that passes everything through untouched
+static Coefficients makePassThroughSection()
+{
+    return new juce::dsp::IIR::Coefficients<float>(1.f, 0.f, 0.f,
+                                                   1.f, 0.f, 0.f);
+}
+
+template<typename CutFilterType>
+static void prepareCutFilterForInPlaceUpdates(CutFilterType& cutFilter)
+{
+    cutFilter.template get<0>().coefficients = makePassThroughSection();
+    cutFilter.template get<1>().coefficients = makePassThroughSection();
+    cutFilter.template get<2>().coefficients = makePassThroughSection();
+    cutFilter.template get<3>().coefficients = makePassThroughSection();
+}
+
+void prepareChainForInPlaceUpdates(MonoChain& chain)
+{
+    prepareCutFilterForInPlaceUpdates(chain.get<ChainPositions::LowCut>());
+    chain.get<ChainPositions::Peak>().coefficients = makePassThroughSection();
+    prepareCutFilterForInPlaceUpdates(chain.get<ChainPositions::HighCut>());
+}
+
+void applyChainCoefficients(MonoChain& chain, const ChainCoefficients& chainCoefficients)
+{
+    chain.setBypassed<ChainPositions::LowCut>(chainCoefficients.lowCutBypass);
+    chain.setBypassed<ChainPositions::Peak>(chainCoefficients.peakBypass);
+    chain.setBypassed<ChainPositions::HighCut>(chainCoefficients.highCutBypass);
+    
+    applyCutFilter(chain.get<ChainPositions::LowCut>(), chainCoefficients.lowCut, chainCoefficients.lowCutSlope);
+    copySectionCoefficients(chain.get<ChainPositions::Peak>().coefficients, chainCoefficients.peak);
+    applyCutFilter(chain.get<ChainPositions::HighCut>(), chainCoefficients.highCut, chainCoefficients.highCutSlope);
+}
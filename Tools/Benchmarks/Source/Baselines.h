@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    Baselines.h
+
+    What the plugin used before its replacements, kept only so the benchmarks
+    can compare against them: the JUCE ProcessorChain (MonoChain) the filter
+    cascade replaced, and the per-channel sample FIFO the analyzer ring
+    replaced.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "../../../Source/Fifo.h"
+#include "../../../Source/DSP/ChainDesign.h"
+
+// Shorthand for basic IIR filter. 12dB/oct by default.
+using Filter = juce::dsp::IIR::Filter<float>;
+// Sub-processing chain for our Low/High Cut filters, consisting of FOUR 12dB/oct filters.
+using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
+// Our single-channel processing chain: (Low)Cut Filter, Peaking Filter, (High)Cut Filter.
+using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
+
+//
+using Coefficients = Filter::CoefficientsPtr;
+
+// Gives every filter in the chain its own 2nd order (pass-through) coefficients object.
+// Allocates! Call before preparing the chain, never on the audio thread.
+void prepareChainForInPlaceUpdates(MonoChain& chain);
+
+// Copies pre-designed coefficients into a chain, in place. Allocation free, safe on the audio thread...
+// ...as long as the chain went through prepareChainForInPlaceUpdates first.
+void applyChainCoefficients(MonoChain& chain, const ChainCoefficients& chainCoefficients);
+
+//==============================================================================
+enum Channel
+{
+    LEFT,   // 0
+    RIGHT   // 1
+};
+
+// Converts some-number-of-samples from a host buffer into a FIFO queue of fixed-size blocks.
+// This was the analyzer tap before MultiChannelSampleRing (SampleRing.h) replaced it.
+template<typename BlockType>
+struct SingleChannelSampleFifo
+{
+    SingleChannelSampleFifo(Channel channel) : channelToUse(channel)
+    {
+        prepared.set(false);
+    }
+    
+    // Takes float or double buffers; the FIFO itself is always float
+    template<typename SampleType>
+    void update(const juce::AudioBuffer<SampleType>& buffer)
+    {
+        jassert(prepared.get());
+        jassert(buffer.getNumChannels() > 0);
+        
+        // A mono buffer has no right channel: both analyzers show channel 0 then
+        auto* channelPtr = buffer.getReadPointer(juce::jmin((int)channelToUse, buffer.getNumChannels() - 1));
+        
+        for (int i = 0; i < buffer.getNumSamples(); i++)
+        {
+            pushNextSampleIntoFifo((float)channelPtr[i]);
+        }
+    }
+    
+    void prepare(int bufferSize)
+    {
+        prepared.set(false);
+        size.set(bufferSize);
+        
+        bufferToFill.setSize(1,             // channel
+                             bufferSize,    // number of samples
+                             false,         // keep existing content?
+                             true,          // clear extra space?
+                             true);         // avoid reallocating?
+        audioBufferFifo.prepare(1, bufferSize);
+        fifoIndex = 0;
+        prepared.set(true);
+    }
+    //===========================================================================
+    int getNumCompleteBuffersAvailable() const { return audioBufferFifo.getNumAvailableForReading(); }
+    bool isPrepared() const { return prepared.get(); }
+    int getSize() const { return size.get(); }
+    //===========================================================================
+    bool getAudioBuffer(BlockType& buffer) { return audioBufferFifo.pull(buffer); }
+private:
+    Channel channelToUse;
+    int fifoIndex = 0;
+    Fifo<BlockType> audioBufferFifo;
+    BlockType bufferToFill;
+    juce::Atomic<bool> prepared = false;
+    juce::Atomic<int> size = 0;
+    
+    void pushNextSampleIntoFifo(float sample)
+    {
+        if (fifoIndex == bufferToFill.getNumSamples())
+        {
+            auto ok = audioBufferFifo.push(bufferToFill);
+            
+            juce::ignoreUnused(ok);
+            
+            fifoIndex = 0;
+        }
+        
+        bufferToFill.setSample(0, fifoIndex, sample);
+        fifoIndex++;
+    }
+};
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    Benchmark.cpp
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+#include "../../../Source/DSP/SIMDVector.h"
+
+#include <iostream>
+
+BenchmarkSuite::BenchmarkSuite(bool quickMode, const juce::String& nameFilter)
+    : quick(quickMode),
+      filter(nameFilter),
+      targetPassSeconds(quickMode ? 0.002 : 0.02),
+      numPasses(quickMode ? 3 : 7)
+{
+}
+
+bool BenchmarkSuite::isWanted(const juce::String& name) const
+{
+    return filter.isEmpty() || name.contains(filter);
+}
+
+void BenchmarkSuite::addResult(const juce::String& name, const juce::NamedValueSet& configuration,
+                               const juce::String& unit, double best, double median)
+{
+    auto* configurationObject = new juce::DynamicObject();
+    for (auto& property : configuration)
+        configurationObject->setProperty(property.name, property.value);
+    
+    auto* result = new juce::DynamicObject();
+    result->setProperty("name", name);
+    result->setProperty("configuration", juce::var(configurationObject));
+    result->setProperty("unit", unit);
+    result->setProperty("best", best);
+    result->setProperty("median", median);
+    results.add(juce::var(result));
+    
+    // Progress on stderr, so stdout can carry the JSON
+    std::cerr << name << " " << juce::JSON::toString(juce::var(configurationObject), true)
+              << ": " << juce::String(best, 2) << " " << unit << std::endl;
+}
+
+juce::var BenchmarkSuite::toJSON(const juce::String& label) const
+{
+    auto* system = new juce::DynamicObject();
+    system->setProperty("cpu", juce::SystemStats::getCpuModel());
+    system->setProperty("cpuVendor", juce::SystemStats::getCpuVendor());
+    system->setProperty("numCpus", juce::SystemStats::getNumCpus());
+    system->setProperty("cpuSpeedMHz", juce::SystemStats::getCpuSpeedInMegahertz());
+    system->setProperty("os", juce::SystemStats::getOperatingSystemName());
+    
+    auto* build = new juce::DynamicObject();
+    build->setProperty("version", ProjectInfo::versionString);
+    build->setProperty("juce", juce::SystemStats::getJUCEVersion());
+    build->setProperty("compiledOn", juce::String(__DATE__) + " " + __TIME__);
+    // Debug numbers are meaningless for tracking regressions, so say loudly which one this is
+   #if JUCE_DEBUG
+    build->setProperty("debug", true);
+   #else
+    build->setProperty("debug", false);
+   #endif
+    build->setProperty("floatLanes", widestFloatVectorLanes);
+    build->setProperty("doubleLanes", widestDoubleVectorLanes);
+    
+    auto* report = new juce::DynamicObject();
+    report->setProperty("schemaVersion", 1);
+    report->setProperty("label", label);
+    report->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+    report->setProperty("quick", quick);
+    report->setProperty("system", juce::var(system));
+    report->setProperty("build", juce::var(build));
+    report->setProperty("results", results);
+    return juce::var(report);
+}
+
+void benchmarkSink(double value)
+{
+    static volatile double sink = 0.0;
+    sink = sink + value;
+}
@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    Benchmark.h
+
+    Timing harness for the DSP micro-benchmarks, and the JSON report.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// Collects timed measurements and writes them out as one JSON report.
+// Each measurement runs its function once to warm up (caches, branch predictors, first-block...
+// ...coefficient pickup), doubles the number of calls per timed pass until a pass takes at least...
+// ...the target time, then times several passes. The fastest pass is the headline number (the...
+// ...others mostly measure the OS getting in the way); the median is kept too, as a noise check.
+class BenchmarkSuite
+{
+public:
+    // quick: shorter passes and fewer of them, for smoke tests rather than numbers worth keeping.
+    // filter: only run measurements whose name contains this (empty = everything)
+    BenchmarkSuite(bool quick, const juce::String& filter);
+    
+    bool isQuick() const { return quick; }
+    bool isWanted(const juce::String& name) const;
+    
+    // Times run(), which processes unitsPerRun units (samples, or calls) each time it's called, and...
+    // ...records nanoseconds per unit under 'name', tagged with 'configuration' (what was being measured).
+    template<typename Function>
+    void measure(const juce::String& name, const juce::NamedValueSet& configuration,
+                 const juce::String& unit, double unitsPerRun, Function&& run)
+    {
+        if ( ! isWanted(name) )
+            return;
+        
+        run();
+        
+        int callsPerPass = 1;
+        while ( timePass(run, callsPerPass) < targetPassSeconds && callsPerPass < (1 << 24) )
+            callsPerPass *= 2;
+        
+        std::vector<double> nanosecondsPerUnit;
+        for (int pass=0; pass<numPasses; pass++)
+            nanosecondsPerUnit.push_back(timePass(run, callsPerPass) * 1.0e9 / ((double)callsPerPass * unitsPerRun));
+        
+        std::sort(nanosecondsPerUnit.begin(), nanosecondsPerUnit.end());
+        addResult(name, configuration, unit, nanosecondsPerUnit.front(), nanosecondsPerUnit[nanosecondsPerUnit.size() / 2]);
+    }
+    
+    // The whole report: where and how it was built and run, then every result
+    juce::var toJSON(const juce::String& label) const;
+    
+    int getNumResults() const { return results.size(); }
+private:
+    template<typename Function>
+    static double timePass(Function& run, int calls)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i=0; i<calls; i++)
+            run();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    
+    void addResult(const juce::String& name, const juce::NamedValueSet& configuration,
+                   const juce::String& unit, double best, double median);
+    
+    bool quick;
+    juce::String filter;
+    double targetPassSeconds;
+    int numPasses;
+    juce::Array<juce::var> results;
+};
+
+// Keeps the optimiser from throwing away work whose result is never used
+void benchmarkSink(double value);
+
+// The suites, in ProcessorBenchmarks.cpp and DSPBenchmarks.cpp
+void runProcessorBenchmarks(BenchmarkSuite& suite);
+void runDSPBenchmarks(BenchmarkSuite& suite);
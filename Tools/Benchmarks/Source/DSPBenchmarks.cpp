@@ -0,0 +1,345 @@
+/*
+  ==============================================================================
+
+    DSPBenchmarks.cpp
+
+    The pieces underneath processBlock: parameter reads, filter design, the
+    filter chains themselves (ours and the JUCE ProcessorChain it replaced),
+    the load meter that times it, the analyzer tap, and the analyzer's dB
+    conversion.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+#include "Baselines.h"
+#include "../../../Source/PluginProcessor.h"
+#include "../../../Source/DSP/FastDecibels.h"
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    
+    const char* getSlopeName(int slope)
+    {
+        static const char* names[] { "12", "24", "36", "48" };
+        return names[slope];
+    }
+    
+    ChainSettings makeSettings(int slope)
+    {
+        ChainSettings settings;
+        settings.lowCutFreq = 80.f;
+        settings.highCutFreq = 12000.f;
+        settings.lowCutSlope = settings.highCutSlope = (Slope)slope;
+        settings.peakFreq = 1000.f;
+        settings.peakGain_dB = 6.f;
+        settings.peakQ = 1.f;
+        return settings;
+    }
+    
+    std::vector<float> makeNoise(int length)
+    {
+        std::vector<float> noise((size_t)length);
+        juce::Random random(0x3BA9DEC);
+        for (auto& sample : noise)
+            sample = random.nextFloat() * 0.5f - 0.25f;
+        return noise;
+    }
+    
+    // Parameter reads and filter design, per call
+    void measureDesign(BenchmarkSuite& suite)
+    {
+        _3BandEQAudioProcessor processor;
+        
+        suite.measure("getChainSettings", {}, "ns/call", 1.0, [&]
+        {
+            benchmarkSink(processor.chainParameters.getChainSettings().peakGain_dB);
+        });
+        
+        for (int slope=0; slope<4; slope++)
+        {
+            const auto settings = makeSettings(slope);
+            
+            juce::NamedValueSet configuration;
+            configuration.set("slope", getSlopeName(slope));
+            
+            // What updateFilters used to do, minus the allocations: design every band
+            ChainCoefficients coefficients;
+            configuration.set("bands", "all");
+            suite.measure("updateChainCoefficients", configuration, "ns/call", 1.0, [&]
+            {
+                updateChainCoefficients(coefficients, settings, sampleRate, ALL_BANDS);
+                benchmarkSink(coefficients.peak[0]);
+            });
+            
+            // The design thread only redesigns the bands that moved
+            configuration.set("bands", "lowCut");
+            suite.measure("updateChainCoefficients", configuration, "ns/call", 1.0, [&]
+            {
+                updateChainCoefficients(coefficients, settings, sampleRate, LOWCUT_BAND);
+                benchmarkSink(coefficients.lowCut[0][0]);
+            });
+            
+            // Copying a finished design into the stereo SIMD chain, as the audio thread does
+            MultiChannelCascade<float> cascade;
+            cascade.prepare(2, blockSize);
+            configuration.remove("bands");
+            suite.measure("applyChainCoefficients", configuration, "ns/call", 1.0, [&]
+            {
+                applyChainCoefficients(cascade, coefficients);
+            });
+        }
+        
+        // A peak move on its own: one section
+        const auto settings = makeSettings(0);
+        ChainCoefficients coefficients;
+        juce::NamedValueSet configuration;
+        configuration.set("bands", "peak");
+        suite.measure("updateChainCoefficients", configuration, "ns/call", 1.0, [&]
+        {
+            updateChainCoefficients(coefficients, settings, sampleRate, PEAK_BAND);
+            benchmarkSink(coefficients.peak[0]);
+        });
+    }
+    
+    // Stereo through our cascade vs. two JUCE MonoChains, per cut filter slope, ns per sample frame
+    void measureChains(BenchmarkSuite& suite)
+    {
+        const auto noise = makeNoise(blockSize);
+        
+        for (int slope=0; slope<4; slope++)
+        {
+            ChainCoefficients coefficients;
+            updateChainCoefficients(coefficients, makeSettings(slope), sampleRate);
+            
+            juce::NamedValueSet configuration;
+            configuration.set("slope", getSlopeName(slope));
+            configuration.set("channels", 2);
+            configuration.set("blockSize", blockSize);
+            
+            std::array<std::vector<float>, 2> channels { noise, noise };
+            std::array<float*, 2> channelPointers { channels[0].data(), channels[1].data() };
+            
+            MultiChannelCascade<float> cascade;
+            cascade.prepare(2, blockSize);
+            applyChainCoefficients(cascade, coefficients);
+            
+            suite.measure("cascade", configuration, "ns/sample", (double)blockSize, [&]
+            {
+                for (auto& channel : channels)
+                    std::copy(noise.begin(), noise.end(), channel.begin());
+                cascade.process(channelPointers.data(), 2, 0, blockSize);
+            });
+            
+            std::array<MonoChain, 2> monoChains;
+            for (auto& monoChain : monoChains)
+            {
+                prepareChainForInPlaceUpdates(monoChain);
+                monoChain.prepare({ sampleRate, (juce::uint32)blockSize, 1 });
+                applyChainCoefficients(monoChain, coefficients);
+            }
+            
+            suite.measure("monoChain", configuration, "ns/sample", (double)blockSize, [&]
+            {
+                for (size_t channel=0; channel<2; channel++)
+                {
+                    std::copy(noise.begin(), noise.end(), channels[channel].begin());
+                    
+                    float* channelPointer = channelPointers[channel];
+                    juce::dsp::AudioBlock<float> block(&channelPointer, 1, (size_t)blockSize);
+                    monoChains[channel].process(juce::dsp::ProcessContextReplacing<float>(block));
+                }
+            });
+        }
+    }
+    
+    // One control tick of coefficient smoothing, per slope: step the ramp and copy it into a stereo...
+    // ...float cascade, as EQEngine does every control interval while smoothing
+    void measureSmootherTick(BenchmarkSuite& suite)
+    {
+        for (int slope=0; slope<4; slope++)
+        {
+            auto settings = makeSettings(slope);
+            ChainCoefficients from, to;
+            updateChainCoefficients(from, settings, sampleRate);
+            settings.peakGain_dB = -6.f;
+            settings.lowCutFreq = 120.f;
+            settings.highCutFreq = 9000.f;
+            updateChainCoefficients(to, settings, sampleRate);
+            
+            MultiChannelCascade<float> cascade;
+            cascade.prepare(2, blockSize);
+            ChainCoefficientSmoother smoother;
+            smoother.setTarget(from, 0);
+            int numRamps = 0;
+            
+            juce::NamedValueSet configuration;
+            configuration.set("slope", getSlopeName(slope));
+            suite.measure("smootherTick", configuration, "ns/tick", 1.0, [&]
+            {
+                // Back and forth between the two, 60 ticks each way
+                if ( ! smoother.isSmoothing() )
+                    smoother.setTarget((numRamps++ & 1) != 0 ? from : to, 60);
+                applyChainCoefficients(cascade, smoother.tick());
+            });
+        }
+    }
+    
+    // One 4-lane cascade with four sections, through its fixed-layout kernel (a 48 dB/oct low cut)...
+    // ...and through the generic loop (the same count in a layout the EQ never makes)
+    void measureKernels(BenchmarkSuite& suite)
+    {
+        using Vector = SIMDVector<float, 4>;
+        using Cascade = BiquadCascade<Vector, float>;
+        
+        const auto noise = makeNoise(blockSize * 4);
+        std::vector<Vector> frames((size_t)blockSize);
+        
+        const auto section = FixedFilterDesign<float>::makeHighPass(sampleRate, 80.0, 0.7071);
+        const std::array<std::array<int, 4>, 2> layouts {{ { 0, 1, 2, 3 }, { 1, 2, 3, 6 } }};
+        
+        for (size_t layout=0; layout<layouts.size(); layout++)
+        {
+            Cascade cascade;
+            for (auto position : layouts[layout])
+                cascade.setSection(position, &section);
+            
+            juce::NamedValueSet configuration;
+            configuration.set("lanes", 4);
+            configuration.set("sections", 4);
+            configuration.set("kernel", layout == 0 ? "fixed" : "generic");
+            
+            suite.measure("cascadeKernel", configuration, "ns/frame", (double)blockSize, [&]
+            {
+                for (size_t i=0; i<frames.size(); i++)
+                    frames[i] = Vector::fromLanes(noise.data() + i * 4);
+                cascade.process(frames.data(), frames.size());
+            });
+        }
+    }
+    
+    // The analyzer tap, per stereo block: the old per-sample FIFO (AudioBuffer copies in and out) against...
+    // ...the bulk ring. Both include the consumer pulling the block back out, so neither ever fills up;...
+    // ..."ringWrite" is the ring's audio thread side alone.
+    void measureAnalyzerTap(BenchmarkSuite& suite)
+    {
+        for (auto tapBlockSize : { 32, 64, 512 })
+        {
+            const auto noise = makeNoise(tapBlockSize * 2);
+            juce::AudioBuffer<float> block(2, tapBlockSize);
+            block.copyFrom(0, 0, noise.data(), tapBlockSize);
+            block.copyFrom(1, 0, noise.data() + tapBlockSize, tapBlockSize);
+            
+            auto getConfiguration = [tapBlockSize](const char* tap)
+            {
+                juce::NamedValueSet configuration;
+                configuration.set("block", tapBlockSize);
+                configuration.set("tap", tap);
+                return configuration;
+            };
+            
+            SingleChannelSampleFifo<juce::AudioBuffer<float>> leftFifo { Channel::LEFT }, rightFifo { Channel::RIGHT };
+            leftFifo.prepare(tapBlockSize);
+            rightFifo.prepare(tapBlockSize);
+            juce::AudioBuffer<float> pulled(1, tapBlockSize);
+            suite.measure("analyzerTap", getConfiguration("fifo"), "ns/sample", (double)tapBlockSize, [&]
+            {
+                leftFifo.update(block);
+                rightFifo.update(block);
+                while ( leftFifo.getAudioBuffer(pulled) ) { }
+                while ( rightFifo.getAudioBuffer(pulled) ) { }
+            });
+            
+            MultiChannelSampleRing ring;
+            ring.prepare(2, 16384);
+            juce::AudioBuffer<float> read(2, tapBlockSize);
+            suite.measure("analyzerTap", getConfiguration("ring"), "ns/sample", (double)tapBlockSize, [&]
+            {
+                ring.write(block.getArrayOfReadPointers(), tapBlockSize);
+                ring.read(read.getArrayOfWritePointers(), tapBlockSize);
+            });
+            
+            suite.measure("analyzerTap", getConfiguration("ringWrite"), "ns/sample", (double)tapBlockSize, [&]
+            {
+                ring.write(block.getArrayOfReadPointers(), tapBlockSize);
+                ring.skip(tapBlockSize);
+            });
+            benchmarkSink(read.getSample(0, 0));
+        }
+    }
+    
+    // Turning one analyzer frame's FFT magnitudes into dB, per FFT size (2048, 4096, 8192). "scalar" is...
+    // ...what FFTDataGenerator used to do: clear the whole 2 * fftSize buffer, copy the window in, then...
+    // ...normalise and gainToDecibels a bin at a time. "fused" is the copy and gainsToDecibels.
+    void measureDecibels(BenchmarkSuite& suite)
+    {
+        for (auto order : { 11, 12, 13 })
+        {
+            const auto fftSize = 1 << order;
+            const auto numBins = fftSize / 2;
+            constexpr float negativeInf = -48.f;
+            
+            // Magnitudes spread over the whole range a spectrum covers, some of them zero
+            std::vector<float> magnitudes((size_t)fftSize);
+            juce::Random random(0x3BA9DEC);
+            for (size_t i=0; i<magnitudes.size(); i++)
+                magnitudes[i] = i % 64 == 0 ? 0.f : std::pow(10.f, random.nextFloat() * 10.f - 6.f);
+            
+            std::vector<float> fftData((size_t)fftSize * 2);
+            
+            auto getConfiguration = [fftSize](const char* conversion)
+            {
+                juce::NamedValueSet configuration;
+                configuration.set("fftSize", fftSize);
+                configuration.set("conversion", conversion);
+                return configuration;
+            };
+            
+            suite.measure("analyzerDecibels", getConfiguration("scalar"), "ns/bin", (double)numBins, [&]
+            {
+                fftData.assign(fftData.size(), 0);
+                std::copy(magnitudes.begin(), magnitudes.end(), fftData.begin());
+                
+                for (int i=0; i<numBins; i++)
+                    fftData[(size_t)i] /= (float)numBins;
+                for (int i=0; i<numBins; i++)
+                    fftData[(size_t)i] = juce::Decibels::gainToDecibels(fftData[(size_t)i], negativeInf);
+            });
+            benchmarkSink(fftData[1]);
+            
+            suite.measure("analyzerDecibels", getConfiguration("fused"), "ns/bin", (double)numBins, [&]
+            {
+                std::copy(magnitudes.begin(), magnitudes.end(), fftData.begin());
+                gainsToDecibels(fftData.data(), numBins, 1.f / (float)numBins, negativeInf);
+            });
+            benchmarkSink(fftData[1]);
+        }
+    }
+    
+    // What timing one processBlock call costs (two counter reads and a histogram update). Compare with...
+    // ...processBlock at 64-sample blocks: this should stay under 1% of it.
+    void measureLoadMeter(BenchmarkSuite& suite)
+    {
+        ProcessLoadMeter meter;
+        meter.prepare(sampleRate);
+        
+        suite.measure("loadMeter", {}, "ns/block", 1.0, [&]
+        {
+            ProcessLoadMeter::ScopedMeasurement measurement { meter, 64 };
+        });
+        benchmarkSink(meter.getStatistics().meanPercent);
+    }
+}
+
+void runDSPBenchmarks(BenchmarkSuite& suite)
+{
+    measureDesign(suite);
+    measureChains(suite);
+    measureKernels(suite);
+    measureSmootherTick(suite);
+    measureLoadMeter(suite);
+    measureAnalyzerTap(suite);
+    measureDecibels(suite);
+}
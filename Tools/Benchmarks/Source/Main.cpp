@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+
+    3BandEQ DSP micro-benchmarks. Writes a JSON report, so numbers can be
+    compared between releases (build the Release configuration for that).
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "Benchmark.h"
+
+#include <iostream>
+
+static void printUsage()
+{
+    std::cout << "Usage:\n"
+                 "  3BandEQ_Benchmarks [--output=<file>] [--label=<text>] [--filter=<text>] [--quick]\n"
+                 "\n"
+                 "  --output   where to write the JSON report (default: stdout; progress goes to stderr)\n"
+                 "  --label    stored in the report, e.g. a release or commit to compare against later\n"
+                 "  --filter   only run benchmarks whose name contains this, e.g. processBlock/slope\n"
+                 "  --quick    short runs, fewer configurations: a smoke test, not numbers worth keeping\n";
+}
+
+int main (int argc, char* argv[])
+{
+    // The processor's parameter tree and async updates expect a message manager to exist
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    
+    juce::ArgumentList args(argc, argv);
+    
+    if ( args.containsOption("--help|-h") )
+    {
+        printUsage();
+        return 0;
+    }
+    
+    BenchmarkSuite suite(args.containsOption("--quick"),
+                         args.containsOption("--filter") ? args.getValueForOption("--filter") : juce::String());
+    
+    runDSPBenchmarks(suite);
+    runProcessorBenchmarks(suite);
+    
+    if ( suite.getNumResults() == 0 )
+    {
+        std::cerr << "No benchmarks matched" << std::endl;
+        return 1;
+    }
+    
+    const auto report = juce::JSON::toString(suite.toJSON(args.containsOption("--label") ? args.getValueForOption("--label")
+                                                                                          : juce::String()));
+    
+    if ( args.containsOption("--output") )
+    {
+        auto file = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--output"));
+        if ( ! file.replaceWithText(report) )
+        {
+            std::cerr << "Couldn't write " << file.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+    else
+    {
+        std::cout << report << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,221 @@
+/*
+  ==============================================================================
+
+    ProcessorBenchmarks.cpp
+
+    processBlock, end to end, as a host would call it.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+#include "../../CLI/Source/ProcessorSetup.h"
+
+#include <array>
+
+namespace
+{
+    constexpr double defaultSampleRate = 48000.0;
+    constexpr int defaultBlockSize = 512;
+    
+    const std::array<int, 9> blockSizes { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+    const std::array<double, 6> sampleRates { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+    
+    struct ProcessorRun
+    {
+        double sampleRate = defaultSampleRate;
+        int blockSize = defaultBlockSize;
+        int numChannels = 2;
+        bool doublePrecision = false;
+        // Parameter values in their own units (see ProcessorSetup::setParameter)
+        juce::StringPairArray parameters;
+        // Sweep Peak_Gain every block, so the design (and any smoothing ramp) runs all the time
+        bool automatePeakGain = false;
+        // Subscribe to the analyzer tap, as an open editor would (the ring is emptied after every block)
+        bool analyzerSubscribed = false;
+    };
+    
+    // ns per sample frame (every channel of one sample) through processBlock.
+    // Each call copies a fresh block of noise in first, as a host would hand over new audio, so the...
+    // ...filters never settle into decaying towards silence.
+    template<typename SampleType>
+    void timeProcessBlock(BenchmarkSuite& suite, const juce::String& name, const ProcessorRun& run,
+                          const juce::NamedValueSet& configuration)
+    {
+        if ( ! suite.isWanted(name) )
+            return;
+        
+        _3BandEQAudioProcessor processor;
+        processor.setProcessingPrecision(run.doublePrecision ? juce::AudioProcessor::doublePrecision
+                                                             : juce::AudioProcessor::singlePrecision);
+        // Automation is designed inline in non-realtime mode, so it's included in the time rather...
+        // ...than happening on the design thread whenever that gets round to it
+        processor.setNonRealtime(run.automatePeakGain);
+        
+        for (auto& parameterID : run.parameters.getAllKeys())
+            ProcessorSetup::setParameter(processor, parameterID, run.parameters[parameterID]);
+        
+        if ( ! ProcessorSetup::prepare(processor, run.numChannels, run.sampleRate, run.blockSize) )
+            return;
+        
+        if ( run.analyzerSubscribed )
+            processor.subscribeToAnalyzer();
+        
+        // A few blocks' worth of noise to cycle through
+        const auto noiseLength = run.blockSize * 8;
+        juce::AudioBuffer<SampleType> noise(run.numChannels, noiseLength);
+        juce::Random random(0x3BA9DEC);
+        for (int channel=0; channel<run.numChannels; channel++)
+            for (int i=0; i<noiseLength; i++)
+                noise.setSample(channel, i, (SampleType)(random.nextFloat() * 0.5f - 0.25f));
+        
+        juce::AudioBuffer<SampleType> block(run.numChannels, run.blockSize);
+        juce::MidiBuffer midi;
+        auto* peakGain = processor.APVTS.getParameter("Peak_Gain");
+        int position = 0;
+        int callCount = 0;
+        
+        suite.measure(name, configuration, "ns/sample", (double)run.blockSize, [&]
+        {
+            for (int channel=0; channel<run.numChannels; channel++)
+                block.copyFrom(channel, 0, noise, channel, position, run.blockSize);
+            position = (position + run.blockSize) % noiseLength;
+            
+            if ( run.automatePeakGain )
+                peakGain->setValueNotifyingHost((float)(++callCount % 64) / 64.f);
+            
+            processor.processBlock(block, midi);
+            
+            if ( run.analyzerSubscribed )
+                processor.analyzerRing.skip(processor.analyzerRing.getNumReady());
+        });
+        
+        if ( run.analyzerSubscribed )
+            processor.unsubscribeFromAnalyzer();
+        processor.releaseResources();
+    }
+    
+    // Adds the basic run settings to the configuration, and times it in the run's precision
+    void measureProcessBlock(BenchmarkSuite& suite, const juce::String& name, const ProcessorRun& run,
+                             juce::NamedValueSet configuration)
+    {
+        configuration.set("sampleRate", run.sampleRate);
+        configuration.set("blockSize", run.blockSize);
+        configuration.set("channels", run.numChannels);
+        configuration.set("precision", run.doublePrecision ? "double" : "float");
+        
+        if ( run.doublePrecision )
+            timeProcessBlock<double>(suite, name, run, configuration);
+        else
+            timeProcessBlock<float>(suite, name, run, configuration);
+    }
+}
+
+void runProcessorBenchmarks(BenchmarkSuite& suite)
+{
+    // Block size x sample rate x bypass combination, at the default settings otherwise.
+    // (Quick mode only walks each axis through the default point.)
+    for (int bypassMask=0; bypassMask<8; bypassMask++)
+    {
+        for (auto sampleRate : sampleRates)
+        {
+            for (auto blockSize : blockSizes)
+            {
+                const auto onAxis = (bypassMask == 0) + (sampleRate == defaultSampleRate) + (blockSize == defaultBlockSize) >= 2;
+                if ( suite.isQuick() && ! onAxis )
+                    continue;
+                
+                ProcessorRun run;
+                run.sampleRate = sampleRate;
+                run.blockSize = blockSize;
+                run.parameters.set("LowCut_Bypass", (bypassMask & 1) != 0 ? "1" : "0");
+                run.parameters.set("Peak_Bypass", (bypassMask & 2) != 0 ? "1" : "0");
+                run.parameters.set("HighCut_Bypass", (bypassMask & 4) != 0 ? "1" : "0");
+                
+                juce::NamedValueSet configuration;
+                configuration.set("lowCutBypass", (bypassMask & 1) != 0);
+                configuration.set("peakBypass", (bypassMask & 2) != 0);
+                configuration.set("highCutBypass", (bypassMask & 4) != 0);
+                measureProcessBlock(suite, "processBlock", run, configuration);
+            }
+        }
+    }
+    
+    // Every low cut / high cut slope pair (12 to 48 dB/oct: 3 to 9 active sections)
+    for (int lowCutSlope=0; lowCutSlope<4; lowCutSlope++)
+    {
+        for (int highCutSlope=0; highCutSlope<4; highCutSlope++)
+        {
+            ProcessorRun run;
+            run.parameters.set("LowCut_Slope", juce::String(lowCutSlope));
+            run.parameters.set("HighCut_Slope", juce::String(highCutSlope));
+            
+            juce::NamedValueSet configuration;
+            configuration.set("lowCutSlope", 12 * (lowCutSlope + 1));
+            configuration.set("highCutSlope", 12 * (highCutSlope + 1));
+            measureProcessBlock(suite, "processBlock/slope", run, configuration);
+        }
+    }
+    
+    // Float vs. double
+    for (auto doublePrecision : { false, true })
+    {
+        ProcessorRun run;
+        run.doublePrecision = doublePrecision;
+        run.parameters.set("LowCut_Slope", "3");
+        run.parameters.set("HighCut_Slope", "3");
+        measureProcessBlock(suite, "processBlock/precision", run, {});
+    }
+    
+    // Channel counts: how well the SIMD batching scales
+    for (auto numChannels : { 1, 2, 4, 6, 8, 12 })
+    {
+        ProcessorRun run;
+        run.numChannels = numChannels;
+        measureProcessBlock(suite, "processBlock/channels", run, {});
+    }
+    
+    // Oversampling factors, and linear phase
+    for (int stages=0; stages<=maxOversamplingStages; stages++)
+    {
+        ProcessorRun run;
+        run.parameters.set("Oversampling", juce::String(stages));
+        
+        juce::NamedValueSet configuration;
+        configuration.set("oversampling", 1 << stages);
+        measureProcessBlock(suite, "processBlock/oversampling", run, configuration);
+    }
+    
+    {
+        ProcessorRun run;
+        run.parameters.set("Linear_Phase", "1");
+        measureProcessBlock(suite, "processBlock/linearPhase", run, {});
+    }
+    
+    // With and without an analyzer subscriber (unsubscribed, the tap does nothing)
+    for (auto blockSize : { 64, 512 })
+    {
+        for (auto subscribed : { false, true })
+        {
+            ProcessorRun run;
+            run.blockSize = blockSize;
+            run.analyzerSubscribed = subscribed;
+            
+            juce::NamedValueSet configuration;
+            configuration.set("analyzer", subscribed ? "subscribed" : "off");
+            measureProcessBlock(suite, "processBlock/analyzerTap", run, configuration);
+        }
+    }
+    
+    // Constant automation with each smoothing control rate: design + ramp + filtering
+    for (size_t smoothing=0; smoothing<smoothingControlIntervals.size(); smoothing++)
+    {
+        ProcessorRun run;
+        run.automatePeakGain = true;
+        run.parameters.set("Smoothing", juce::String((int)smoothing));
+        
+        juce::NamedValueSet configuration;
+        configuration.set("controlInterval", smoothingControlIntervals[smoothing]);
+        measureProcessBlock(suite, "processBlock/automation", run, configuration);
+    }
+}
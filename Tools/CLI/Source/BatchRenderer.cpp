@@ -0,0 +1,223 @@
+/*
+  ==============================================================================
+
+    BatchRenderer.cpp
+
+  ==============================================================================
+*/
+
+#include "BatchRenderer.h"
+#include "ProcessorSetup.h"
+#include "WorkStealingPool.h"
+
+#include <atomic>
+#include <iostream>
+
+namespace
+{
+    constexpr int defaultBlockSize = 8192;
+
+    // Totals across all workers, printed at the end
+    struct RenderStats
+    {
+        std::atomic<int> filesRendered {0};
+        std::atomic<int> filesFailed {0};
+        std::atomic<juce::int64> audioMicroseconds {0};
+    };
+
+    // Renders one file. The processor belongs to the calling worker.
+    bool renderFile(_3BandEQAudioProcessor& processor,
+                    juce::AudioFormatManager& formats,
+                    const juce::File& inputFile,
+                    const juce::File& outputFile,
+                    int blockSize,
+                    RenderStats& stats,
+                    juce::String& error)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(inputFile));
+        if ( reader == nullptr )
+        {
+            error = "can't read this file";
+            return false;
+        }
+        
+        const auto numChannels = (int)reader->numChannels;
+        const auto sampleRate = reader->sampleRate;
+        const auto lengthInSamples = reader->lengthInSamples;
+        
+        if ( ! ProcessorSetup::prepare(processor, numChannels, sampleRate, blockSize) )
+        {
+            error = "unsupported channel count";
+            return false;
+        }
+        
+        // Same format and (where the format allows it) the same bit depth as the input
+        auto* format = formats.findFormatForFileExtension(inputFile.getFileExtension());
+        auto bitDepth = (int)reader->bitsPerSample;
+        if ( ! format->getPossibleBitDepths().contains(bitDepth) )
+            bitDepth = format->getPossibleBitDepths().getLast();
+        
+        outputFile.deleteFile();
+        auto outputStream = outputFile.createOutputStream();
+        if ( outputStream == nullptr )
+        {
+            error = "can't create " + outputFile.getFullPathName();
+            processor.releaseResources();
+            return false;
+        }
+        
+        std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(outputStream.get(),
+                                                                                sampleRate,
+                                                                                (unsigned int)numChannels,
+                                                                                bitDepth,
+                                                                                reader->metadataValues,
+                                                                                0));
+        if ( writer == nullptr )
+        {
+            error = "can't write this format";
+            processor.releaseResources();
+            return false;
+        }
+        outputStream.release(); // the writer owns it now
+        
+        // Stream through in blocks. Reads past the end of the file come back as silence, which...
+        // ...flushes the processor's latency out; the first 'latency' output samples are dropped so...
+        // ...the rendered file lines up with the original.
+        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+        juce::MidiBuffer midi;
+        auto samplesToSkip = (juce::int64)processor.getLatencySamples();
+        juce::int64 samplesWritten = 0;
+        
+        for (juce::int64 readPosition = 0; samplesWritten < lengthInSamples; readPosition += blockSize)
+        {
+            reader->read(&buffer, 0, blockSize, readPosition, true, true);
+            processor.processBlock(buffer, midi);
+            
+            const auto start = (int)juce::jmin(samplesToSkip, (juce::int64)blockSize);
+            samplesToSkip -= start;
+            
+            const auto numToWrite = (int)juce::jmin((juce::int64)(blockSize - start), lengthInSamples - samplesWritten);
+            if ( numToWrite > 0 && ! writer->writeFromAudioSampleBuffer(buffer, start, numToWrite) )
+            {
+                error = "write failed";
+                processor.releaseResources();
+                return false;
+            }
+            samplesWritten += numToWrite;
+        }
+        
+        processor.releaseResources();
+        stats.audioMicroseconds += (juce::int64)((double)lengthInSamples * 1.0e6 / sampleRate);
+        return true;
+    }
+}
+
+int runBatchRender(const juce::ArgumentList& args)
+{
+    const auto batchIndex = args.indexOfOption("--batch");
+    if ( batchIndex < 0 || batchIndex + 2 >= args.size() )
+    {
+        std::cerr << "--batch needs an input and an output directory" << std::endl;
+        return 1;
+    }
+    
+    const auto inputDirectory = args[batchIndex + 1].resolveAsFile();
+    const auto outputDirectory = args[batchIndex + 2].resolveAsFile();
+    if ( ! inputDirectory.isDirectory() )
+    {
+        std::cerr << "Not a directory: " << inputDirectory.getFullPathName() << std::endl;
+        return 1;
+    }
+    if ( ! outputDirectory.createDirectory() )
+    {
+        std::cerr << "Can't create " << outputDirectory.getFullPathName() << std::endl;
+        return 1;
+    }
+    // Outputs keep their input's name, and an existing output is deleted before it's written: in the...
+    // ...input directory that would be the very file being read
+    if ( inputDirectory.getLinkedTarget() == outputDirectory.getLinkedTarget() )
+    {
+        std::cerr << "The output directory can't be the input directory" << std::endl;
+        return 1;
+    }
+    
+    ProcessorSetup setup;
+    juce::String error;
+    if ( ! setup.parse(args, error) )
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    
+    const auto numThreads = args.containsOption("--threads") ? args.getValueForOption("--threads").getIntValue()
+                                                             : juce::SystemStats::getNumCpus();
+    const auto blockSize = args.containsOption("--block") ? juce::jmax(32, args.getValueForOption("--block").getIntValue())
+                                                          : defaultBlockSize;
+    
+    // Every file a registered format claims, whatever case its extension is in (wildcards are case...
+    // ...sensitive on Linux, so "*.wav" would miss FOO.WAV)
+    juce::Array<juce::File> inputFiles;
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+        for (auto& file : inputDirectory.findChildFiles(juce::File::findFiles, false))
+            if ( formats.findFormatForFileExtension(file.getFileExtension()) != nullptr )
+                inputFiles.add(file);
+    }
+    inputFiles.sort();
+    
+    WorkStealingPool pool(juce::jlimit(1, juce::jmax(1, inputFiles.size()), numThreads));
+    
+    // One processor (and format manager) per worker, set up here on the main thread
+    std::vector<std::unique_ptr<_3BandEQAudioProcessor>> processors;
+    std::vector<std::unique_ptr<juce::AudioFormatManager>> formatManagers;
+    for (int i=0; i<pool.getNumWorkers(); i++)
+    {
+        processors.push_back(std::make_unique<_3BandEQAudioProcessor>());
+        processors.back()->setNonRealtime(true);
+        if ( ! setup.applyTo(*processors.back(), error) )
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        
+        formatManagers.push_back(std::make_unique<juce::AudioFormatManager>());
+        formatManagers.back()->registerBasicFormats();
+    }
+    
+    RenderStats stats;
+    std::mutex consoleLock;
+    
+    for (auto& inputFile : inputFiles)
+    {
+        pool.addJob([&, inputFile] (int worker)
+        {
+            juce::String fileError;
+            auto outputFile = outputDirectory.getChildFile(inputFile.getFileName());
+            auto rendered = renderFile(*processors[(size_t)worker], *formatManagers[(size_t)worker],
+                                       inputFile, outputFile, blockSize, stats, fileError);
+            
+            (rendered ? stats.filesRendered : stats.filesFailed)++;
+            
+            std::lock_guard<std::mutex> guard(consoleLock);
+            if ( rendered )
+                std::cout << inputFile.getFileName() << std::endl;
+            else
+                std::cerr << inputFile.getFileName() << ": " << fileError << std::endl;
+        });
+    }
+    
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+    pool.run();
+    const auto elapsedSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+    
+    const auto audioSeconds = (double)stats.audioMicroseconds.load() / 1.0e6;
+    std::cout << "\n"
+              << stats.filesRendered.load() << " files rendered, " << stats.filesFailed.load() << " failed, "
+              << pool.getNumWorkers() << " threads, " << blockSize << " sample blocks\n"
+              << juce::String(elapsedSeconds, 2) << " s: "
+              << juce::String(elapsedSeconds > 0.0 ? stats.filesRendered.load() / elapsedSeconds : 0.0, 2) << " files/s, "
+              << juce::String(elapsedSeconds > 0.0 ? audioSeconds / elapsedSeconds : 0.0, 1) << "x realtime" << std::endl;
+    
+    return stats.filesFailed.load() > 0 ? 1 : 0;
+}
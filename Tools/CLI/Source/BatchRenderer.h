@@ -0,0 +1,21 @@
+/*
+  ==============================================================================
+
+    BatchRenderer.h
+
+    Offline rendering of whole directories of audio files through the EQ.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// --batch <input directory> <output directory> [--threads=N] [--block=N] [processor setup options]
+// Every audio file in the input directory (any extension a registered format claims, in any case) is...
+// ...rendered into a file of the same name and format in the output directory. One job per file on a...
+// ...work-stealing pool, one processor per worker. The two directories must differ.
+// Files are streamed a block at a time, so memory use doesn't depend on file length.
+// Returns the process exit code.
+int runBatchRender(const juce::ArgumentList& args);
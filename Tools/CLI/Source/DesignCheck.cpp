@@ -0,0 +1,177 @@
+/*
+  ==============================================================================
+
+    DesignCheck.cpp
+
+  ==============================================================================
+*/
+
+#include "DesignCheck.h"
+#include "../../../Source/DSP/BiquadDesign.h"
+
+#include <iostream>
+#include <type_traits>
+
+namespace
+{
+    const double sampleRates[] { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+    
+    // Allowed difference, relative to the JUCE coefficient (but never tighter than relative to 1e-2,...
+    // ...so a coefficient that ought to be 0, like the peak's cos term at fs / 4, isn't judged on the...
+    // ...last bits of a rounding error). Double: a few ULP of a double (the worst seen is ~4e-14).
+    // Float: JUCE designs in float and we design in double and round, so JUCE's own rounding counts...
+    // ...too. The worst seen is ~3.5e-5, in the peak's 1 - alpha * A terms at high Q and gain, where...
+    // ...float cancels away a few digits.
+    template<typename FloatType>
+    constexpr double getTolerance()
+    {
+        return std::is_same<FloatType, double>::value ? 1.0e-12 : 1.0e-4;
+    }
+    
+    struct CheckResults
+    {
+        int numCoefficients = 0;
+        int numMismatches = 0;
+        double worstError = 0.0;
+        bool verbose = false;
+        
+        // Compares one of our sections with JUCE's (a 2nd order Coefficients object)
+        template<typename FloatType>
+        void compare(const typename FixedFilterDesign<FloatType>::Section& ours,
+                     const juce::dsp::IIR::Coefficients<FloatType>& theirs,
+                     const juce::String& description)
+        {
+            if ( theirs.getFilterOrder() != 2 )
+            {
+                report(description + ": JUCE designed a section of order " + juce::String((int)theirs.getFilterOrder()));
+                return;
+            }
+            
+            static const char* names[] { "b0", "b1", "b2", "a1", "a2" };
+            const auto* raw = theirs.getRawCoefficients();
+            
+            for (size_t i=0; i<ours.size(); i++)
+            {
+                const auto reference = (double)raw[i];
+                const auto error = std::abs((double)ours[i] - reference) / juce::jmax(std::abs(reference), 1.0e-2);
+                
+                numCoefficients++;
+                worstError = juce::jmax(worstError, error);
+                
+                if ( error > getTolerance<FloatType>() )
+                    report(description + " " + names[i] + ": ours " + juce::String((double)ours[i], 17)
+                           + ", JUCE " + juce::String(reference, 17));
+            }
+        }
+        
+        void report(const juce::String& message)
+        {
+            constexpr int maxReported = 20;
+            if ( verbose || numMismatches < maxReported )
+                std::cerr << "MISMATCH " << message << std::endl;
+            numMismatches++;
+        }
+    };
+    
+    // 20 Hz to 20 kHz, log spaced, plus the ends of the EQ's ranges exactly
+    juce::Array<double> getFrequencies(int numSteps)
+    {
+        juce::Array<double> frequencies;
+        for (int i=0; i<=numSteps; i++)
+            frequencies.add(20.0 * std::pow(1000.0, (double)i / (double)numSteps));
+        return frequencies;
+    }
+    
+    template<typename FloatType>
+    void checkCutFilters(CheckResults& results)
+    {
+        using Design = FixedFilterDesign<FloatType>;
+        
+        for (auto sampleRate : sampleRates)
+        {
+            for (auto frequency : getFrequencies(120))
+            {
+                // Orders 2, 4, 6 and 8: the four cut filter slopes
+                for (int order=2; order<=8; order+=2)
+                {
+                    const auto description = juce::String(std::is_same<FloatType, double>::value ? "double" : "float")
+                                           + " order " + juce::String(order) + " " + juce::String(frequency, 2)
+                                           + " Hz @ " + juce::String(sampleRate) + " Hz";
+                    
+                    typename Design::template Cascade<4> ours {};
+                    
+                    const auto numHighPass = Design::designButterworthHighPass(ours, frequency, sampleRate, order);
+                    const auto theirHighPass = juce::dsp::FilterDesign<FloatType>::designIIRHighpassHighOrderButterworthMethod((FloatType)frequency, sampleRate, order);
+                    if ( numHighPass != theirHighPass.size() )
+                        results.report(description + " high pass: " + juce::String(numHighPass) + " sections, JUCE "
+                                       + juce::String(theirHighPass.size()));
+                    for (int i=0; i<juce::jmin(numHighPass, theirHighPass.size()); i++)
+                        results.compare<FloatType>(ours[(size_t)i], *theirHighPass[i], description + " high pass section " + juce::String(i));
+                    
+                    const auto numLowPass = Design::designButterworthLowPass(ours, frequency, sampleRate, order);
+                    const auto theirLowPass = juce::dsp::FilterDesign<FloatType>::designIIRLowpassHighOrderButterworthMethod((FloatType)frequency, sampleRate, order);
+                    if ( numLowPass != theirLowPass.size() )
+                        results.report(description + " low pass: " + juce::String(numLowPass) + " sections, JUCE "
+                                       + juce::String(theirLowPass.size()));
+                    for (int i=0; i<juce::jmin(numLowPass, theirLowPass.size()); i++)
+                        results.compare<FloatType>(ours[(size_t)i], *theirLowPass[i], description + " low pass section " + juce::String(i));
+                }
+            }
+        }
+    }
+    
+    template<typename FloatType>
+    void checkPeakFilters(CheckResults& results)
+    {
+        using Design = FixedFilterDesign<FloatType>;
+        
+        for (auto sampleRate : sampleRates)
+        {
+            for (auto frequency : getFrequencies(40))
+            {
+                // The Peak_Q range (0.1 to 10), log spaced
+                for (int q=0; q<=12; q++)
+                {
+                    const auto Q = 0.1 * std::pow(100.0, (double)q / 12.0);
+                    
+                    // The Peak_Gain range, -24 to +24 dB
+                    for (int gain=-24; gain<=24; gain+=3)
+                    {
+                        // Both sides get the same gain factor: the dB conversion isn't what's being checked
+                        const auto gainFactor = (FloatType)juce::Decibels::decibelsToGain((double)gain);
+                        
+                        const auto ours = Design::makePeakFilter(sampleRate, frequency, Q, (double)gainFactor);
+                        const auto theirs = juce::dsp::IIR::Coefficients<FloatType>::makePeakFilter(sampleRate, (FloatType)frequency,
+                                                                                                    (FloatType)Q, gainFactor);
+                        
+                        results.compare<FloatType>(ours, *theirs,
+                                                   juce::String(std::is_same<FloatType, double>::value ? "double" : "float")
+                                                   + " peak " + juce::String(frequency, 2) + " Hz Q " + juce::String(Q, 3)
+                                                   + " " + juce::String(gain) + " dB @ " + juce::String(sampleRate) + " Hz");
+                    }
+                }
+            }
+        }
+    }
+}
+
+int runDesignCheck(const juce::ArgumentList& args)
+{
+    CheckResults doubleResults, floatResults;
+    doubleResults.verbose = floatResults.verbose = args.containsOption("--verbose");
+    
+    checkCutFilters<double>(doubleResults);
+    checkPeakFilters<double>(doubleResults);
+    checkCutFilters<float>(floatResults);
+    checkPeakFilters<float>(floatResults);
+    
+    for (auto* results : { &doubleResults, &floatResults })
+    {
+        std::cout << (results == &doubleResults ? "double: " : "float:  ")
+                  << results->numCoefficients << " coefficients checked, "
+                  << results->numMismatches << " mismatches, worst relative error "
+                  << results->worstError << std::endl;
+    }
+    
+    return doubleResults.numMismatches == 0 && floatResults.numMismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,25 @@
+/*
+  ==============================================================================
+
+    DesignCheck.h
+
+    Checks the EQ's own filter designer (FixedFilterDesign, BiquadDesign.h)
+    against the JUCE designs it replaced, coefficient by coefficient.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// --design-check [--verbose]
+// For every sample rate from 44.1 to 192 kHz, compares:
+//   every cut filter order (2, 4, 6, 8: the four slopes), low and high pass, over a sweep of...
+//   ...frequencies, against juce::dsp::FilterDesign's high order Butterworth methods
+//   the peak filter over a sweep of frequencies, Q and gain, against IIR::Coefficients::makePeakFilter
+// FixedFilterDesign<double> (what the EQ runs) is held to JUCE's double precision designs within a...
+// ...few ULP; FixedFilterDesign<float> to JUCE's float designs within float rounding.
+// Mismatches are printed (all of them with --verbose, otherwise the first few).
+// Returns the process exit code: 0 if every coefficient matched.
+int runDesignCheck(const juce::ArgumentList& args);
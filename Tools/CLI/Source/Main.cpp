@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+
+    3BandEQ command line tool: runs the plugin's processor without a host
+    or an editor.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "BatchRenderer.h"
+#include "PipeMode.h"
+#include "RealtimeCheck.h"
+#include "DesignCheck.h"
+
+#include <iostream>
+
+static void printUsage()
+{
+    std::cout << "Usage:\n"
+                 "  3BandEQ_CLI --batch <input dir> <output dir> [--threads=N] [--block=N] [setup]\n"
+                 "  3BandEQ_CLI --pipe [--rate=N] [--channels=N] [--block=N] [--format=f32|s16]\n"
+                 "              [--control-fd=N] [setup]\n"
+                 "      raw interleaved PCM from stdin to stdout. Control fd lines: <sample time> <ID> <value>\n"
+                 "  3BandEQ_CLI --rt-check [--rate=N] [--channels=N] [--block=N] [--trap]\n"
+                 "      runs every parameter configuration, failing on any allocation, lock or blocking call\n"
+                 "      in processBlock. Needs the RTCheck build configuration (EQ_REALTIME_CHECKS=1)\n"
+                 "  3BandEQ_CLI --design-check [--verbose]\n"
+                 "      compares the EQ's filter designs with JUCE's, coefficient by coefficient, failing on\n"
+                 "      any mismatch\n"
+                 "\n"
+                 "Setup (applied in this order):\n"
+                 "  --state <file>          processor state saved by getStateInformation\n"
+                 "  --param <ID>=<value>    parameter value in its own units, e.g. LowCut_Freq=80,\n"
+                 "                          LowCut_Slope=2 (choice index), Peak_Bypass=1\n";
+}
+
+int main (int argc, char* argv[])
+{
+    // The processor's parameter tree and async updates expect a message manager to exist
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    
+    juce::ArgumentList args(argc, argv);
+    
+    if ( args.containsOption("--batch") )
+        return runBatchRender(args);
+    
+    if ( args.containsOption("--pipe") )
+        return runPipe(args);
+    
+    if ( args.containsOption("--rt-check") )
+        return runRealtimeCheck(args);
+    
+    if ( args.containsOption("--design-check") )
+        return runDesignCheck(args);
+    
+    printUsage();
+    return args.size() == 0 || args.containsOption("--help|-h") ? 0 : 1;
+}
@@ -0,0 +1,355 @@
+/*
+  ==============================================================================
+
+    PipeMode.cpp
+
+  ==============================================================================
+*/
+
+#include "PipeMode.h"
+#include "ProcessorSetup.h"
+
+#include <array>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    enum SampleFormat
+    {
+        FLOAT32,
+        INT16
+    };
+    
+    // Blocks in flight: one being read, one being processed, one being written, plus one spare...
+    // ...so each stage always has the next block queued up
+    constexpr int numBlockSlots = 4;
+    
+    struct BlockSlot
+    {
+        std::vector<char> bytes;
+        int numFrames = 0;
+        double readTimeMs = 0.0;
+    };
+    
+    // Minimal blocking queue of slot indices between the pipeline's threads
+    class SlotQueue
+    {
+    public:
+        void push(int slot)
+        {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                slots.push_back(slot);
+            }
+            condition.notify_one();
+        }
+        
+        // Waits for a slot. Returns false once the queue is closed and empty.
+        bool pop(int& slot)
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            condition.wait(guard, [this] { return ! slots.empty() || closed; });
+            if ( slots.empty() )
+                return false;
+            
+            slot = slots.front();
+            slots.pop_front();
+            return true;
+        }
+        
+        void close()
+        {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                closed = true;
+            }
+            condition.notify_all();
+        }
+    private:
+        std::mutex lock;
+        std::condition_variable condition;
+        std::deque<int> slots;
+        bool closed = false;
+    };
+    
+    // Parameter changes from the control file descriptor, kept in time order
+    class ParameterEvents
+    {
+    public:
+        // Any thread. Accepts "<sample time> <parameter ID> <value>"; anything else is ignored.
+        void addLine(const juce::String& line)
+        {
+            auto tokens = juce::StringArray::fromTokens(line.trim(), " \t", "");
+            if ( tokens.size() != 3 )
+                return;
+            
+            Event event { tokens[0].getLargeIntValue(), tokens[1], tokens[2] };
+            
+            std::lock_guard<std::mutex> guard(lock);
+            auto position = events.end();
+            while ( position != events.begin() && std::prev(position)->sampleTime > event.sampleTime )
+                --position;
+            events.insert(position, event);
+        }
+        
+        // Applies every event due at or before sampleTime, and returns when the next one is due
+        juce::int64 applyDue(_3BandEQAudioProcessor& processor, juce::int64 sampleTime)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            while ( ! events.empty() && events.front().sampleTime <= sampleTime )
+            {
+                if ( ! ProcessorSetup::setParameter(processor, events.front().parameterID, events.front().value) )
+                    std::cerr << "Unknown parameter " << events.front().parameterID << std::endl;
+                events.pop_front();
+            }
+            return events.empty() ? std::numeric_limits<juce::int64>::max() : events.front().sampleTime;
+        }
+    private:
+        struct Event
+        {
+            juce::int64 sampleTime;
+            juce::String parameterID, value;
+        };
+        
+        std::mutex lock;
+        std::deque<Event> events;
+    };
+    
+    int getBytesPerSample(SampleFormat format) { return format == FLOAT32 ? 4 : 2; }
+    
+    void deinterleave(const BlockSlot& slot, SampleFormat format, juce::AudioBuffer<float>& buffer)
+    {
+        const auto numChannels = buffer.getNumChannels();
+        
+        if ( format == FLOAT32 )
+        {
+            auto* source = reinterpret_cast<const float*>(slot.bytes.data());
+            for (int channel=0; channel<numChannels; channel++)
+            {
+                auto* destination = buffer.getWritePointer(channel);
+                for (int i=0; i<slot.numFrames; i++)
+                    destination[i] = source[i * numChannels + channel];
+            }
+        }
+        else
+        {
+            auto* source = reinterpret_cast<const juce::int16*>(slot.bytes.data());
+            for (int channel=0; channel<numChannels; channel++)
+            {
+                auto* destination = buffer.getWritePointer(channel);
+                for (int i=0; i<slot.numFrames; i++)
+                    destination[i] = (float)source[i * numChannels + channel] * (1.f / 32768.f);
+            }
+        }
+    }
+    
+    void interleave(const juce::AudioBuffer<float>& buffer, SampleFormat format, BlockSlot& slot)
+    {
+        const auto numChannels = buffer.getNumChannels();
+        
+        if ( format == FLOAT32 )
+        {
+            auto* destination = reinterpret_cast<float*>(slot.bytes.data());
+            for (int channel=0; channel<numChannels; channel++)
+            {
+                auto* source = buffer.getReadPointer(channel);
+                for (int i=0; i<slot.numFrames; i++)
+                    destination[i * numChannels + channel] = source[i];
+            }
+        }
+        else
+        {
+            auto* destination = reinterpret_cast<juce::int16*>(slot.bytes.data());
+            for (int channel=0; channel<numChannels; channel++)
+            {
+                auto* source = buffer.getReadPointer(channel);
+                for (int i=0; i<slot.numFrames; i++)
+                    destination[i * numChannels + channel] = (juce::int16)juce::jlimit(-32768, 32767, juce::roundToInt(source[i] * 32768.f));
+            }
+        }
+    }
+    
+    int getIntOption(const juce::ArgumentList& args, const juce::String& option, int defaultValue)
+    {
+        return args.containsOption(option) ? args.getValueForOption(option).getIntValue() : defaultValue;
+    }
+}
+
+int runPipe(const juce::ArgumentList& args)
+{
+    const auto sampleRate = (double)getIntOption(args, "--rate", 48000);
+    const auto numChannels = getIntOption(args, "--channels", 2);
+    const auto blockSize = getIntOption(args, "--block", 512);
+    const auto controlFd = getIntOption(args, "--control-fd", -1);
+    const auto formatName = args.containsOption("--format") ? args.getValueForOption("--format") : juce::String("f32");
+    
+    if ( sampleRate <= 0.0 || numChannels <= 0 || blockSize <= 0 || (formatName != "f32" && formatName != "s16") )
+    {
+        std::cerr << "--pipe needs a positive rate, channel count and block size, and a format of f32 or s16" << std::endl;
+        return 1;
+    }
+    const auto format = formatName == "f32" ? FLOAT32 : INT16;
+    const auto bytesPerFrame = (size_t)(numChannels * getBytesPerSample(format));
+    
+    ProcessorSetup setup;
+    juce::String error;
+    _3BandEQAudioProcessor processor;
+    if ( ! setup.parse(args, error) || ! setup.applyTo(processor, error) )
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    
+    // Non-realtime: parameter changes are designed inline, so each change starts exactly where it's scheduled
+    processor.setNonRealtime(true);
+    if ( ! ProcessorSetup::prepare(processor, numChannels, sampleRate, blockSize) )
+    {
+        std::cerr << "Unsupported channel count" << std::endl;
+        return 1;
+    }
+    
+    const auto processorLatency = processor.getLatencySamples();
+    const auto bufferingLatency = blockSize * (numBlockSlots - 1);
+    std::cerr << "Latency: " << processorLatency << " samples processing + up to " << bufferingLatency
+              << " samples buffering (" << juce::String((processorLatency + bufferingLatency) * 1000.0 / sampleRate, 1)
+              << " ms at most)" << std::endl;
+    
+    // Control lines are read on their own thread. It's detached rather than joined, since the other...
+    // ...end may keep the descriptor open long after the audio has finished.
+    auto events = std::make_shared<ParameterEvents>();
+    if ( controlFd >= 0 )
+    {
+       #if JUCE_WINDOWS
+        std::cerr << "--control-fd isn't supported on Windows" << std::endl;
+        return 1;
+       #else
+        auto* controlFile = fdopen(controlFd, "r");
+        if ( controlFile == nullptr )
+        {
+            std::cerr << "Can't open control fd " << controlFd << std::endl;
+            return 1;
+        }
+        
+        std::thread([events, controlFile]
+        {
+            char line[512];
+            while ( std::fgets(line, sizeof(line), controlFile) != nullptr )
+                events->addLine(line);
+        }).detach();
+       #endif
+    }
+    
+    std::array<BlockSlot, numBlockSlots> slots;
+    SlotQueue freeSlots, readSlots, processedSlots;
+    for (int i=0; i<numBlockSlots; i++)
+    {
+        slots[(size_t)i].bytes.resize(bytesPerFrame * (size_t)blockSize);
+        freeSlots.push(i);
+    }
+    
+    // Reader: stdin -> readSlots
+    std::thread reader([&]
+    {
+        int slotIndex;
+        while ( freeSlots.pop(slotIndex) )
+        {
+            auto& slot = slots[(size_t)slotIndex];
+            
+            size_t bytesRead = 0;
+            while ( bytesRead < slot.bytes.size() )
+            {
+                auto numRead = std::fread(slot.bytes.data() + bytesRead, 1, slot.bytes.size() - bytesRead, stdin);
+                if ( numRead == 0 )
+                    break;
+                bytesRead += numRead;
+            }
+            
+            slot.numFrames = (int)(bytesRead / bytesPerFrame);
+            slot.readTimeMs = juce::Time::getMillisecondCounterHiRes();
+            
+            if ( slot.numFrames > 0 )
+                readSlots.push(slotIndex);
+            
+            // End of input (a partial last frame is dropped)
+            if ( bytesRead < slot.bytes.size() )
+                break;
+        }
+        readSlots.close();
+    });
+    
+    // Writer: processedSlots -> stdout
+    double totalLatencyMs = 0.0, maxLatencyMs = 0.0;
+    int numBlocksWritten = 0;
+    std::thread writer([&]
+    {
+        int slotIndex;
+        while ( processedSlots.pop(slotIndex) )
+        {
+            auto& slot = slots[(size_t)slotIndex];
+            std::fwrite(slot.bytes.data(), bytesPerFrame, (size_t)slot.numFrames, stdout);
+            std::fflush(stdout);
+            
+            auto latencyMs = juce::Time::getMillisecondCounterHiRes() - slot.readTimeMs;
+            totalLatencyMs += latencyMs;
+            maxLatencyMs = juce::jmax(maxLatencyMs, latencyMs);
+            numBlocksWritten++;
+            
+            freeSlots.push(slotIndex);
+        }
+        freeSlots.close();
+    });
+    
+    // DSP, on this thread: readSlots -> processedSlots
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    juce::MidiBuffer midi;
+    juce::int64 streamPosition = 0;
+    auto latency = processorLatency;
+    
+    int slotIndex;
+    while ( readSlots.pop(slotIndex) )
+    {
+        auto& slot = slots[(size_t)slotIndex];
+        deinterleave(slot, format, buffer);
+        
+        // Split the block wherever a parameter change is due
+        for (int frame = 0; frame < slot.numFrames; )
+        {
+            const auto nextEvent = events->applyDue(processor, streamPosition + frame);
+            
+            // Oversampling and phase mode changes switch over inline (the processor is non-realtime),...
+            // ...and can move the latency
+            if ( processor.getLatencySamples() != latency )
+            {
+                latency = processor.getLatencySamples();
+                std::cerr << "Latency at sample " << streamPosition + frame << ": " << latency << " samples processing" << std::endl;
+            }
+            const auto end = (int)juce::jmin((juce::int64)slot.numFrames, nextEvent - streamPosition);
+            
+            juce::AudioBuffer<float> part(buffer.getArrayOfWritePointers(), numChannels, frame, end - frame);
+            processor.processBlock(part, midi);
+            frame = end;
+        }
+        
+        interleave(buffer, format, slot);
+        streamPosition += slot.numFrames;
+        processedSlots.push(slotIndex);
+    }
+    
+    processedSlots.close();
+    writer.join();
+    reader.join();
+    processor.releaseResources();
+    
+    if ( numBlocksWritten > 0 )
+        std::cerr << "Measured read-to-write latency per block: " << juce::String(totalLatencyMs / numBlocksWritten, 2)
+                  << " ms average, " << juce::String(maxLatencyMs, 2) << " ms max" << std::endl;
+    return 0;
+}
@@ -0,0 +1,24 @@
+/*
+  ==============================================================================
+
+    PipeMode.h
+
+    Streams raw PCM from stdin through the EQ to stdout.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// --pipe [--rate=48000] [--channels=2] [--block=512] [--format=f32|s16] [--control-fd=N] [processor setup options]
+// Interleaved native-endian float32 or int16 frames in on stdin, the same format out on stdout.
+// Reading, processing and writing run on three threads with two blocks in flight between each pair,...
+// ...so the DSP overlaps the I/O on both sides.
+// With --control-fd, lines of the form "<sample time> <parameter ID> <value>" are read from that file...
+// ...descriptor and applied exactly at that sample (the block is split there). Sample times count...
+// ...frames from the start of the stream; events that arrive late are applied straight away.
+// Latency (the processor's plus the pipeline's) is reported on stderr.
+// Returns the process exit code.
+int runPipe(const juce::ArgumentList& args);
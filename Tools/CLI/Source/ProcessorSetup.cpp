@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    ProcessorSetup.cpp
+
+  ==============================================================================
+*/
+
+#include "ProcessorSetup.h"
+
+bool ProcessorSetup::parse(const juce::ArgumentList& args, juce::String& error)
+{
+    for (int i=0; i<args.size(); i++)
+    {
+        const auto& argument = args[i];
+        
+        if ( argument == "--state" || argument == "--param" )
+        {
+            if ( i + 1 >= args.size() )
+            {
+                error = argument.text + " needs a value";
+                return false;
+            }
+            
+            const auto value = args[++i].text;
+            
+            if ( argument == "--state" )
+            {
+                auto file = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+                if ( ! file.loadFileAsData(state) )
+                {
+                    error = "Couldn't read state file " + file.getFullPathName();
+                    return false;
+                }
+            }
+            else
+            {
+                if ( ! value.contains("=") )
+                {
+                    error = "--param expects <ID>=<value>, got " + value;
+                    return false;
+                }
+                parameters.set(value.upToFirstOccurrenceOf("=", false, false).trim(),
+                               value.fromFirstOccurrenceOf("=", false, false).trim());
+            }
+        }
+    }
+    return true;
+}
+
+bool ProcessorSetup::applyTo(_3BandEQAudioProcessor& processor, juce::String& error) const
+{
+    if ( state.getSize() > 0 )
+        processor.setStateInformation(state.getData(), (int)state.getSize());
+    
+    for (auto& parameterID : parameters.getAllKeys())
+    {
+        if ( ! setParameter(processor, parameterID, parameters[parameterID]) )
+        {
+            error = "Unknown parameter " + parameterID;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ProcessorSetup::prepare(_3BandEQAudioProcessor& processor, int numChannels, double sampleRate, int blockSize)
+{
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+    layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+    if ( ! processor.setBusesLayout(layout) )
+        return false;
+    
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+    return true;
+}
+
+bool ProcessorSetup::setParameter(_3BandEQAudioProcessor& processor, const juce::String& parameterID, const juce::String& value)
+{
+    auto* parameter = processor.APVTS.getParameter(parameterID);
+    if ( parameter == nullptr )
+        return false;
+    
+    // Bypass switches also take the usual words
+    auto plainValue = value.getFloatValue();
+    if ( value.equalsIgnoreCase("true") || value.equalsIgnoreCase("on") )
+        plainValue = 1.f;
+    
+    parameter->setValueNotifyingHost(parameter->convertTo0to1(plainValue));
+    return true;
+}
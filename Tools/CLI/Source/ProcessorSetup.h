@@ -0,0 +1,38 @@
+/*
+  ==============================================================================
+
+    ProcessorSetup.h
+
+    How the command line tools configure a headless _3BandEQAudioProcessor:
+    a saved state blob and/or individual parameter values.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+
+// Parsed from:
+//     --state <file>          a blob saved by getStateInformation (e.g. exported from a DAW session)
+//     --param <ID>=<value>    any number of these, applied after the state. Values are in the...
+//                             ...parameter's own units (Hz, dB, choice index, 0/1 for bypasses)
+struct ProcessorSetup
+{
+    // Returns false (with a message in 'error') if an option is malformed or a file is missing
+    bool parse(const juce::ArgumentList& args, juce::String& error);
+
+    // Loads the state, then sets the parameters. Call before preparing the processor.
+    // Returns false (with a message in 'error') for unknown parameter IDs.
+    bool applyTo(_3BandEQAudioProcessor& processor, juce::String& error) const;
+
+    // Puts the processor in the same channel layout / rate / block size a host would, and prepares it
+    static bool prepare(_3BandEQAudioProcessor& processor, int numChannels, double sampleRate, int blockSize);
+
+    // Sets one parameter from a value in its own units
+    static bool setParameter(_3BandEQAudioProcessor& processor, const juce::String& parameterID, const juce::String& value);
+
+    juce::MemoryBlock state;
+    juce::StringPairArray parameters;
+};
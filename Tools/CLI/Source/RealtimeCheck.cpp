@@ -0,0 +1,133 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.cpp
+
+  ==============================================================================
+*/
+
+#include "RealtimeCheck.h"
+#include "ProcessorSetup.h"
+#include "../../../Source/RealtimeSafety.h"
+
+#include <iostream>
+#include <type_traits>
+
+namespace
+{
+    int getIntOption(const juce::ArgumentList& args, const juce::String& option, int defaultValue)
+    {
+        return args.containsOption(option) ? args.getValueForOption(option).getIntValue() : defaultValue;
+    }
+    
+    // Moves every continuous parameter somewhere new, and designs and publishes the result before the...
+    // ...next block (so the smoother keeps ramping while blocks are processed)
+    void automateContinuousParameters(_3BandEQAudioProcessor& processor, juce::Random& random)
+    {
+        for (auto* parameterID : { "LowCut_Freq", "HighCut_Freq", "Peak_Freq", "Peak_Gain", "Peak_Q" })
+            processor.APVTS.getParameter(parameterID)->setValueNotifyingHost(random.nextFloat());
+        processor.useTimeSlice();
+    }
+    
+    // Returns the number of configurations run, or -1 if the processor couldn't be prepared
+    template<typename SampleType>
+    int checkConfigurations(double sampleRate, int numChannels, int blockSize, juce::Random& random)
+    {
+        constexpr int numSlopes = 4;
+        constexpr int numBypassCombinations = 8;
+        const int numModes = 2 * (maxOversamplingStages + 1) * (int)smoothingControlIntervals.size();
+        const int numLayouts = numSlopes * numSlopes * numBypassCombinations;
+        
+        juce::AudioBuffer<SampleType> buffer(numChannels, blockSize);
+        juce::MidiBuffer midi;
+        const int blockSizes[] = { blockSize, juce::jmax(1, blockSize / 2), juce::jmin(blockSize, 37), 1 };
+        int numConfigurations = 0;
+        
+        for (int mode = 0; mode < numModes; mode++)
+        {
+            // Phase mode, oversampling and smoothing are picked up when the processor is prepared
+            _3BandEQAudioProcessor processor;
+            processor.setProcessingPrecision(std::is_same<SampleType, double>::value ? juce::AudioProcessor::doublePrecision
+                                                                                     : juce::AudioProcessor::singlePrecision);
+            const auto smoothing = mode % (int)smoothingControlIntervals.size();
+            const auto stages = (mode / (int)smoothingControlIntervals.size()) % (maxOversamplingStages + 1);
+            const auto linearPhase = mode / ((int)smoothingControlIntervals.size() * (maxOversamplingStages + 1));
+            ProcessorSetup::setParameter(processor, "Smoothing", juce::String(smoothing));
+            ProcessorSetup::setParameter(processor, "Oversampling", juce::String(stages));
+            ProcessorSetup::setParameter(processor, "Linear_Phase", juce::String(linearPhase));
+            
+            if ( ! ProcessorSetup::prepare(processor, numChannels, sampleRate, blockSize) )
+                return -1;
+            
+            // With the analyzer tap running, as if the editor were open
+            processor.subscribeToAnalyzer();
+            
+            for (int layout = 0; layout < numLayouts; layout++)
+            {
+                const auto bypasses = layout / (numSlopes * numSlopes);
+                ProcessorSetup::setParameter(processor, "LowCut_Slope", juce::String(layout % numSlopes));
+                ProcessorSetup::setParameter(processor, "HighCut_Slope", juce::String((layout / numSlopes) % numSlopes));
+                ProcessorSetup::setParameter(processor, "LowCut_Bypass", juce::String(bypasses & 1));
+                ProcessorSetup::setParameter(processor, "Peak_Bypass", juce::String((bypasses >> 1) & 1));
+                ProcessorSetup::setParameter(processor, "HighCut_Bypass", juce::String((bypasses >> 2) & 1));
+                
+                // Design and publish the new layout right here, rather than hoping the design thread...
+                // ...(it polls every few ms) gets to it before the blocks below run
+                processor.useTimeSlice();
+                
+                for (auto numSamples : blockSizes)
+                {
+                    for (int channel = 0; channel < numChannels; channel++)
+                        for (int i = 0; i < numSamples; i++)
+                            buffer.setSample(channel, i, (SampleType)(random.nextFloat() * 2.f - 1.f));
+                    
+                    automateContinuousParameters(processor, random);
+                    
+                    juce::AudioBuffer<SampleType> block(buffer.getArrayOfWritePointers(), numChannels, numSamples);
+                    processor.processBlock(block, midi);
+                    processor.analyzerRing.skip(processor.analyzerRing.getNumReady());
+                }
+                numConfigurations++;
+            }
+            
+            processor.unsubscribeFromAnalyzer();
+            processor.releaseResources();
+        }
+        return numConfigurations;
+    }
+}
+
+int runRealtimeCheck(const juce::ArgumentList& args)
+{
+    if ( ! RealtimeSafety::isEnabled() )
+    {
+        std::cerr << "--rt-check needs a build with EQ_REALTIME_CHECKS=1 (the RTCheck configuration)" << std::endl;
+        return 2;
+    }
+    
+    const auto sampleRate = (double)getIntOption(args, "--rate", 48000);
+    const auto numChannels = getIntOption(args, "--channels", 2);
+    const auto blockSize = getIntOption(args, "--block", 512);
+    if ( sampleRate <= 0.0 || numChannels <= 0 || blockSize <= 0 )
+    {
+        std::cerr << "--rt-check needs a positive rate, channel count and block size" << std::endl;
+        return 1;
+    }
+    
+    RealtimeSafety::setFailureMode(args.containsOption("--trap") ? RealtimeSafety::TRAP_ON_VIOLATION
+                                                                 : RealtimeSafety::LOG_VIOLATIONS);
+    RealtimeSafety::resetViolationCount();
+    
+    juce::Random random(1234);
+    const auto numFloat = checkConfigurations<float>(sampleRate, numChannels, blockSize, random);
+    const auto numDouble = checkConfigurations<double>(sampleRate, numChannels, blockSize, random);
+    if ( numFloat < 0 || numDouble < 0 )
+    {
+        std::cerr << "Unsupported channel count" << std::endl;
+        return 1;
+    }
+    
+    const auto numViolations = RealtimeSafety::getNumViolations();
+    std::cout << numFloat + numDouble << " configurations checked, " << numViolations << " realtime safety violations" << std::endl;
+    return numViolations == 0 ? 0 : 1;
+}
@@ -0,0 +1,25 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.h
+
+    Drives processBlock through every parameter configuration and fails on
+    any realtime safety violation (see RealtimeSafety.h).
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// --rt-check [--rate=48000] [--channels=2] [--block=512] [--trap]
+// Needs a build with EQ_REALTIME_CHECKS=1 (the RTCheck configuration).
+// For both precisions and every phase mode / oversampling / smoothing setting, prepares a processor...
+// ...(realtime, like a host) and runs every slope and bypass combination through it, at full, half,...
+// ...odd and single sample block sizes, while the continuous parameters are automated between blocks.
+// The analyzer tap is subscribed to throughout, as if an editor were open.
+// Parameter changes happen between blocks, off the audio thread: only processBlock itself is checked.
+// Violations are logged with a stack trace as they happen; --trap aborts on the first one instead.
+// Returns the process exit code: 0 if processBlock stayed realtime safe throughout.
+int runRealtimeCheck(const juce::ArgumentList& args);
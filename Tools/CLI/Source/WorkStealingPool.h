@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+    WorkStealingPool.h
+
+    A fixed set of worker threads with one job deque each.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Jobs are dealt out round-robin before the run starts. Each worker takes jobs from the front of its...
+// ...own deque and, once that runs dry, steals from the back of the other workers' deques, so a worker...
+// ...that drew a few long files doesn't hold everyone else up. Jobs are told which worker runs them,...
+// ...so they can use per-worker resources (e.g. one processor instance per worker) without locking.
+class WorkStealingPool
+{
+public:
+    using Job = std::function<void(int workerIndex)>;
+
+    explicit WorkStealingPool(int numWorkers)
+        : queues((size_t)(numWorkers > 0 ? numWorkers : 1))
+    {
+    }
+
+    int getNumWorkers() const { return (int)queues.size(); }
+
+    // Before run() only
+    void addJob(Job job)
+    {
+        queues[nextQueue].jobs.push_back(std::move(job));
+        nextQueue = (nextQueue + 1) % queues.size();
+    }
+
+    // Runs every job, returning once they have all finished
+    void run()
+    {
+        std::vector<std::thread> workers;
+        for (int i=0; i<getNumWorkers(); i++)
+            workers.emplace_back([this, i] { runWorker(i); });
+
+        for (auto& worker : workers)
+            worker.join();
+    }
+private:
+    struct Queue
+    {
+        std::mutex lock;
+        std::deque<Job> jobs;
+    };
+
+    void runWorker(int workerIndex)
+    {
+        Job job;
+        while ( takeJob(workerIndex, job) )
+            job(workerIndex);
+    }
+
+    bool takeJob(int workerIndex, Job& job)
+    {
+        // Own work first, oldest first...
+        {
+            auto& queue = queues[(size_t)workerIndex];
+            std::lock_guard<std::mutex> guard(queue.lock);
+            if ( ! queue.jobs.empty() )
+            {
+                job = std::move(queue.jobs.front());
+                queue.jobs.pop_front();
+                return true;
+            }
+        }
+
+        // ...then steal from the other end of everyone else's. Nothing is added during a run,...
+        // ...so once every queue is empty we're done.
+        for (size_t offset=1; offset<queues.size(); offset++)
+        {
+            auto& queue = queues[((size_t)workerIndex + offset) % queues.size()];
+            std::lock_guard<std::mutex> guard(queue.lock);
+            if ( ! queue.jobs.empty() )
+            {
+                job = std::move(queue.jobs.back());
+                queue.jobs.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<Queue> queues;
+    size_t nextQueue = 0;
+};